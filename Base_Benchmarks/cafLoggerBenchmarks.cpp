@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include "cafLogger.h"
+
+#include "spdlog/sinks/base_sink.h"
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/**
+ * Formats every record like a file sink would, without the I/O
+ */
+class FormattingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::atomic<size_t> count = 0u;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& msg ) override
+    {
+        spdlog::memory_buf_t formatted;
+        formatter_->format( msg, formatted );
+        benchmark::DoNotOptimize( formatted.data() );
+        count.fetch_add( 1u, std::memory_order_relaxed );
+    }
+    void flush_() override {}
+};
+} // namespace
+
+/**
+ * Log batches of records round-robin to a set of loggers and wait for all of them to be written.
+ * The argument is the number of async workers, with 0 meaning synchronous loggers.
+ */
+static void BM_LoggerThroughput( benchmark::State& state )
+{
+    constexpr size_t loggerCount = 8u;
+    constexpr size_t batchSize   = 10000u;
+
+    caffa::Logger::enableAsyncLogging( static_cast<size_t>( state.range( 0 ) ),
+                                       batchSize,
+                                       caffa::Logger::OverflowPolicy::block );
+
+    std::vector<std::shared_ptr<spdlog::logger>> loggers;
+    std::vector<std::shared_ptr<FormattingSink>> sinks;
+    for ( size_t i = 0; i < loggerCount; ++i )
+    {
+        auto loggerName = "benchmark.throughput" + std::to_string( i );
+        sinks.push_back( std::make_shared<FormattingSink>() );
+        caffa::Logger::registerCustomSink( loggerName, sinks.back() );
+        loggers.push_back( caffa::Logger::findLogger( loggerName ) );
+    }
+    caffa::Logger::enableAsyncLogging( 0u );
+
+    const std::string message = "Benchmark record with a payload of a typical length for a log line";
+
+    size_t logged = 0u;
+    for ( auto _ : state )
+    {
+        for ( size_t i = 0; i < batchSize; ++i )
+        {
+            caffa::Logger::log( loggers[logged++ % loggerCount], caffa::Logger::Level::info, message );
+        }
+
+        size_t written = 0u;
+        while ( written < logged )
+        {
+            written = 0u;
+            for ( const auto& sink : sinks )
+            {
+                written += sink->count.load( std::memory_order_relaxed );
+            }
+            if ( written < logged ) std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed( static_cast<int64_t>( logged ) );
+
+    for ( size_t i = 0; i < loggerCount; ++i )
+    {
+        spdlog::drop( "benchmark.throughput" + std::to_string( i ) );
+    }
+}
+BENCHMARK( BM_LoggerThroughput )->Arg( 0 )->Arg( 1 )->Arg( 2 )->Arg( 4 )->UseRealTime();
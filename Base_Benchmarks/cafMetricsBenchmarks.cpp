@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+
+#include "cafMetrics.h"
+
+namespace
+{
+void BM_CounterIncrement( benchmark::State& state )
+{
+    static auto& counter = caffa::Metrics::counter( "benchmark_counter_increments_total" );
+    for ( auto _ : state )
+    {
+        counter.increment();
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_CounterIncrement )->ThreadRange( 1, 8 );
+
+void BM_HistogramRecord( benchmark::State& state )
+{
+    static auto& histogram = caffa::Metrics::histogram( "benchmark_histogram_values" );
+    uint64_t     value     = 1u;
+    for ( auto _ : state )
+    {
+        histogram.record( value );
+        value = value * 6364136223846793005u + 1442695040888963407u;
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_HistogramRecord )->ThreadRange( 1, 8 );
+
+} // namespace
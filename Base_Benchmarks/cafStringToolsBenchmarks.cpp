@@ -0,0 +1,196 @@
+#include <benchmark/benchmark.h>
+
+#include "cafStringTools.h"
+
+#include <algorithm>
+#include <cctype>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace
+{
+// Log-like text where the first byte of the needle is common, but the needle itself only appears at the end
+std::string longText( size_t length )
+{
+    std::mt19937 random( 1 );
+    std::string  text;
+    text.reserve( length + 64u );
+    while ( text.size() < length )
+    {
+        text += "[info] [request " + std::to_string( random() % 100000 ) + "] in progress; ";
+    }
+    return text + "[error] request failed";
+}
+
+void BM_FindStandardLibrary( benchmark::State& state )
+{
+    const std::string text = longText( static_cast<size_t>( state.range( 0 ) ) );
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( std::string_view( text ).find( "[error]" ) );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK( BM_FindStandardLibrary )->Range( 1 << 10, 1 << 20 );
+
+void BM_FindEngine( benchmark::State& state, caffa::StringTools::SearchEngine engine )
+{
+    const std::string text = longText( static_cast<size_t>( state.range( 0 ) ) );
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( caffa::StringTools::find( engine, text, "[error]" ) );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK_CAPTURE( BM_FindEngine, scalar, caffa::StringTools::SearchEngine::Scalar )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_CAPTURE( BM_FindEngine, best, caffa::StringTools::bestSearchEngine() )->Range( 1 << 10, 1 << 20 );
+
+void BM_SplitLongInput( benchmark::State& state )
+{
+    const std::string text = longText( 1 << 20 );
+    for ( auto _ : state )
+    {
+        size_t parts = 0u;
+        for ( auto part : caffa::StringTools::split_view( text, "; " ) )
+        {
+            benchmark::DoNotOptimize( part );
+            ++parts;
+        }
+        benchmark::DoNotOptimize( parts );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK( BM_SplitLongInput );
+
+void BM_ReplaceLongInput( benchmark::State& state )
+{
+    const std::string text = longText( 1 << 20 );
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( caffa::StringTools::replace( text, "in progress", "done" ) );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK( BM_ReplaceLongInput );
+
+// An importer line: many short fields separated by commas with optional white space
+std::string csvLine()
+{
+    std::string line;
+    for ( int i = 0; i < 200; ++i )
+    {
+        line += "field number " + std::to_string( i ) + ( i % 3 == 0 ? " , " : "," );
+    }
+    return line;
+}
+
+void BM_SplitRegexTokenIterator( benchmark::State& state )
+{
+    const std::string line = csvLine();
+    for ( auto _ : state )
+    {
+        // What callers typically do: build the regex every time
+        boost::regex regex( "\\s*,\\s*" );
+        std::list<std::string> parts;
+        boost::sregex_token_iterator it( line.begin(), line.end(), regex, -1 ), end;
+        for ( ; it != end; ++it )
+            parts.push_back( *it );
+        benchmark::DoNotOptimize( parts );
+    }
+    state.SetBytesProcessed( state.iterations() * line.size() );
+}
+BENCHMARK( BM_SplitRegexTokenIterator );
+
+void BM_SplitRegexCached( benchmark::State& state )
+{
+    const std::string line = csvLine();
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( caffa::StringTools::splitRegex( line, "\\s*,\\s*" ) );
+    }
+    state.SetBytesProcessed( state.iterations() * line.size() );
+}
+BENCHMARK( BM_SplitRegexCached );
+
+void BM_ToLowerLocale( benchmark::State& state )
+{
+    std::string key = "Some-Mixed-Case-Configuration-Key.With.Several.Parts";
+    for ( auto _ : state )
+    {
+        std::ranges::transform( key, key.begin(), []( unsigned char c ) { return (char)std::tolower( c ); } );
+        benchmark::DoNotOptimize( key );
+    }
+    state.SetBytesProcessed( state.iterations() * key.size() );
+}
+BENCHMARK( BM_ToLowerLocale );
+
+void BM_ToLowerInPlace( benchmark::State& state )
+{
+    std::string key = "Some-Mixed-Case-Configuration-Key.With.Several.Parts";
+    for ( auto _ : state )
+    {
+        caffa::StringTools::tolower_in_place( key );
+        benchmark::DoNotOptimize( key );
+    }
+    state.SetBytesProcessed( state.iterations() * key.size() );
+}
+BENCHMARK( BM_ToLowerInPlace );
+
+void BM_CaseInsensitiveHash( benchmark::State& state )
+{
+    const std::string key = "Some-Mixed-Case-Configuration-Key.With.Several.Parts";
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( caffa::StringTools::ihash( key ) );
+    }
+    state.SetBytesProcessed( state.iterations() * key.size() );
+}
+BENCHMARK( BM_CaseInsensitiveHash );
+
+// A template with dozens of different placeholders, each used a few times
+std::pair<std::string, caffa::StringTools::MultiReplace::Replacements> templateWithPlaceholders()
+{
+    caffa::StringTools::MultiReplace::Replacements replacements;
+    for ( int i = 0; i < 40; ++i )
+    {
+        replacements.emplace_back( "{placeholder" + std::to_string( i ) + "}", "value " + std::to_string( i ) );
+    }
+    std::string text;
+    for ( int i = 0; i < 400; ++i )
+    {
+        text += "Some template text with " + replacements[( i * 7 ) % replacements.size()].first + " in it. ";
+    }
+    return { text, replacements };
+}
+
+void BM_ReplaceEachPlaceholder( benchmark::State& state )
+{
+    const auto [text, replacements] = templateWithPlaceholders();
+    for ( auto _ : state )
+    {
+        std::string expanded = text;
+        for ( const auto& [what, with] : replacements )
+        {
+            expanded = caffa::StringTools::replace( expanded, what, with );
+        }
+        benchmark::DoNotOptimize( expanded );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK( BM_ReplaceEachPlaceholder );
+
+void BM_ReplaceMany( benchmark::State& state )
+{
+    const auto [text, replacements] = templateWithPlaceholders();
+    const caffa::StringTools::MultiReplace placeholders( replacements );
+    for ( auto _ : state )
+    {
+        benchmark::DoNotOptimize( placeholders.apply( text ) );
+    }
+    state.SetBytesProcessed( state.iterations() * text.size() );
+}
+BENCHMARK( BM_ReplaceMany );
+
+} // namespace
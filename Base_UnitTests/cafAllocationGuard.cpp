@@ -0,0 +1,259 @@
+#include "cafAllocationGuard.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef __GLIBC__
+#define CAFFA_TRACK_MALLOC
+#endif
+
+namespace
+{
+// Constant initialised so counting works from the very first allocation of every thread
+thread_local size_t t_allocationCount = 0u;
+thread_local size_t t_allocationBytes = 0u;
+
+inline void countAllocation( size_t size ) noexcept
+{
+    t_allocationCount++;
+    t_allocationBytes += size;
+}
+} // namespace
+
+#ifdef CAFFA_TRACK_MALLOC
+extern "C"
+{
+void* __libc_malloc( size_t size ) noexcept;
+void* __libc_calloc( size_t count, size_t size ) noexcept;
+void* __libc_realloc( void* pointer, size_t size ) noexcept;
+void* __libc_memalign( size_t alignment, size_t size ) noexcept;
+void  __libc_free( void* pointer ) noexcept;
+
+void* malloc( size_t size ) noexcept
+{
+    countAllocation( size );
+    return __libc_malloc( size );
+}
+
+void* calloc( size_t count, size_t size ) noexcept
+{
+    countAllocation( count * size );
+    return __libc_calloc( count, size );
+}
+
+void* realloc( void* pointer, size_t size ) noexcept
+{
+    countAllocation( size );
+    return __libc_realloc( pointer, size );
+}
+
+void* memalign( size_t alignment, size_t size ) noexcept
+{
+    countAllocation( size );
+    return __libc_memalign( alignment, size );
+}
+
+void* aligned_alloc( size_t alignment, size_t size ) noexcept
+{
+    countAllocation( size );
+    return __libc_memalign( alignment, size );
+}
+
+int posix_memalign( void** pointer, size_t alignment, size_t size ) noexcept
+{
+    if ( alignment % sizeof( void* ) != 0u || ( alignment & ( alignment - 1u ) ) != 0u ) return EINVAL;
+
+    countAllocation( size );
+    *pointer = __libc_memalign( alignment, size );
+    return *pointer ? 0 : ENOMEM;
+}
+
+void free( void* pointer ) noexcept
+{
+    __libc_free( pointer );
+}
+}
+#endif
+
+namespace
+{
+void* allocate( size_t size ) noexcept
+{
+#ifndef CAFFA_TRACK_MALLOC
+    countAllocation( size );
+#endif
+    return std::malloc( size ? size : 1u );
+}
+
+void* allocateAligned( size_t size, std::align_val_t alignment ) noexcept
+{
+    auto align = static_cast<size_t>( alignment );
+#ifndef CAFFA_TRACK_MALLOC
+    countAllocation( size );
+#endif
+#ifdef _WIN32
+    return _aligned_malloc( size ? size : 1u, align );
+#else
+    return std::aligned_alloc( align, ( ( size ? size : 1u ) + align - 1u ) / align * align );
+#endif
+}
+
+void deallocateAligned( void* pointer ) noexcept
+{
+#ifdef _WIN32
+    _aligned_free( pointer );
+#else
+    std::free( pointer );
+#endif
+}
+
+void* allocateOrThrow( size_t size )
+{
+    if ( auto pointer = allocate( size ); pointer ) return pointer;
+    throw std::bad_alloc();
+}
+
+void* allocateAlignedOrThrow( size_t size, std::align_val_t alignment )
+{
+    if ( auto pointer = allocateAligned( size, alignment ); pointer ) return pointer;
+    throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new( size_t size )
+{
+    return allocateOrThrow( size );
+}
+
+void* operator new[]( size_t size )
+{
+    return allocateOrThrow( size );
+}
+
+void* operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+    return allocate( size );
+}
+
+void* operator new[]( size_t size, const std::nothrow_t& ) noexcept
+{
+    return allocate( size );
+}
+
+void* operator new( size_t size, std::align_val_t alignment )
+{
+    return allocateAlignedOrThrow( size, alignment );
+}
+
+void* operator new[]( size_t size, std::align_val_t alignment )
+{
+    return allocateAlignedOrThrow( size, alignment );
+}
+
+void* operator new( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept
+{
+    return allocateAligned( size, alignment );
+}
+
+void* operator new[]( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept
+{
+    return allocateAligned( size, alignment );
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[]( void* pointer ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, size_t ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[]( void* pointer, size_t ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, const std::nothrow_t& ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[]( void* pointer, const std::nothrow_t& ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, std::align_val_t ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+void operator delete[]( void* pointer, std::align_val_t ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+void operator delete( void* pointer, size_t, std::align_val_t ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+void operator delete[]( void* pointer, size_t, std::align_val_t ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+void operator delete( void* pointer, std::align_val_t, const std::nothrow_t& ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+void operator delete[]( void* pointer, std::align_val_t, const std::nothrow_t& ) noexcept
+{
+    deallocateAligned( pointer );
+}
+
+using namespace caffa;
+
+AllocationGuard::AllocationGuard() noexcept
+    : m_startCount( t_allocationCount )
+    , m_startBytes( t_allocationBytes )
+{
+}
+
+size_t AllocationGuard::count() const noexcept
+{
+    return t_allocationCount - m_startCount;
+}
+
+size_t AllocationGuard::bytes() const noexcept
+{
+    return t_allocationBytes - m_startBytes;
+}
+
+void AllocationGuard::reset() noexcept
+{
+    m_startCount = t_allocationCount;
+    m_startBytes = t_allocationBytes;
+}
+
+bool AllocationGuard::tracksMalloc() noexcept
+{
+#ifdef CAFFA_TRACK_MALLOC
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace caffa
+{
+/**
+ * Counts the heap allocations made by the current thread while the guard is alive.
+ *
+ * Linking the caffaAllocationTracking library replaces the global operator new and delete and, with glibc, also
+ * malloc, calloc, realloc and the aligned allocation functions, so allocations made inside other libraries are
+ * counted as well. Guards can be nested.
+ *
+ *   caffa::AllocationGuard guard;
+ *   hotPath();
+ *   EXPECT_EQ( 0u, guard.count() );
+ */
+class AllocationGuard
+{
+public:
+    AllocationGuard() noexcept;
+
+    size_t count() const noexcept;
+    size_t bytes() const noexcept;
+
+    /**
+     * Start counting from zero again
+     */
+    void reset() noexcept;
+
+    /**
+     * Whether allocations made directly with malloc and friends are counted, or only those through operator new
+     */
+    static bool tracksMalloc() noexcept;
+
+private:
+    size_t m_startCount;
+    size_t m_startBytes;
+};
+} // namespace caffa
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+
+#include "cafAllocationGuard.h"
+#include "cafLogger.h"
+#include "cafStringTools.h"
+#include "cafUuidGenerator.h"
+
+#include "spdlog/sinks/null_sink.h"
+#include "spdlog/spdlog.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * Allocations made by one call once any lazily created state and caches are in place
+ */
+template <typename Function>
+size_t steadyStateAllocations( Function function )
+{
+    function();
+    function();
+
+    caffa::AllocationGuard guard;
+    function();
+    return guard.count();
+}
+
+const std::string loggerName = "test.allocations";
+
+class TestAllocations : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        caffa::Logger::registerCustomSink( loggerName, std::make_shared<spdlog::sinks::null_sink_mt>() );
+        caffa::Logger::setLogLevel( loggerName, caffa::Logger::Level::info );
+    }
+
+    void TearDown() override { spdlog::drop( loggerName ); }
+};
+} // namespace
+
+TEST_F( TestAllocations, guardCountsAllocations )
+{
+    // Through volatile pointers so the compiler cannot leave out the allocations
+    caffa::AllocationGuard guard;
+    int* volatile          value = new int( 1 );
+    delete value;
+    EXPECT_EQ( 1u, guard.count() );
+    {
+        caffa::AllocationGuard inner;
+        char* volatile         buffer = static_cast<char*>( std::malloc( 1000u ) );
+        std::free( buffer );
+        EXPECT_EQ( caffa::AllocationGuard::tracksMalloc() ? 1u : 0u, inner.count() );
+    }
+    EXPECT_EQ( caffa::AllocationGuard::tracksMalloc() ? 2u : 1u, guard.count() );
+
+    guard.reset();
+    EXPECT_EQ( 0u, guard.count() );
+}
+
+TEST_F( TestAllocations, disabledLoggingMacros )
+{
+    EXPECT_EQ( 0u, steadyStateAllocations( []() { CAFFA_DEBUG_SINK( loggerName, "value " << 42 ); } ) );
+    EXPECT_EQ( 0u, steadyStateAllocations( []() { CAFFA_TRACE_SINK( loggerName, "value " << 42 ); } ) );
+}
+
+TEST_F( TestAllocations, enabledLoggingMacros )
+{
+    // The message string itself, which is handed on to the sinks
+    EXPECT_LE( steadyStateAllocations( []() { CAFFA_INFO_SINK( loggerName, "value " << 42 ); } ), 1u );
+    EXPECT_LE( steadyStateAllocations(
+                   []() { CAFFA_INFO_SINK( loggerName, "a message too long for the small string buffer " << 42 ); } ),
+               3u );
+}
+
+TEST_F( TestAllocations, stringTools )
+{
+    const std::string              text  = "alpha,beta,gamma,delta";
+    const std::vector<std::string> words = { "alpha", "beta", "gamma", "delta" };
+    const std::string longText = "   a text too long for the small string buffer, so trimming has to allocate   ";
+
+    // One node per part
+    EXPECT_LE( steadyStateAllocations( [&]() { EXPECT_EQ( 4u, caffa::StringTools::split( text, "," ).size() ); } ),
+               4u );
+    // The vector growing to four
+    EXPECT_LE( steadyStateAllocations(
+                   [&]()
+                   {
+                       auto parts = caffa::StringTools::split<std::vector<std::string>>( text, "," );
+                       EXPECT_EQ( 4u, parts.size() );
+                   } ),
+               3u );
+    EXPECT_EQ( 0u,
+               steadyStateAllocations(
+                   [&]()
+                   {
+                       size_t size = 0u;
+                       for ( auto part : caffa::StringTools::split_view( text, ',' ) )
+                           size += part.size();
+                       EXPECT_EQ( 19u, size );
+                   } ) );
+    std::vector<std::string_view> views;
+    EXPECT_EQ( 0u, steadyStateAllocations( [&]() { caffa::StringTools::split_into( views, text, ',' ); } ) );
+    std::vector<std::string> fields;
+    EXPECT_EQ( 0u, steadyStateAllocations( [&]() { caffa::StringTools::split_into( fields, longText, ' ', true ); } ) );
+    // The size is computed up front, so only the result is allocated
+    EXPECT_EQ( 1u,
+               steadyStateAllocations( [&]() { EXPECT_EQ( 22u, caffa::StringTools::join( words, "," ).size() ); } ) );
+    std::string buffer;
+    buffer.reserve( 64u );
+    EXPECT_EQ( 0u,
+               steadyStateAllocations(
+                   [&]()
+                   {
+                       buffer.clear();
+                       caffa::StringTools::join_to( buffer, words, "," );
+                   } ) );
+    // The results are checked so the calls cannot be optimised away
+    const size_t trimmedSize = longText.size() - 6u;
+    EXPECT_EQ( 0u,
+               steadyStateAllocations( []() { EXPECT_EQ( 5u, caffa::StringTools::trim( "  short  " ).size() ); } ) );
+    EXPECT_LE(
+        steadyStateAllocations( [&]() { EXPECT_EQ( trimmedSize, caffa::StringTools::trim( longText ).size() ); } ),
+        1u );
+    EXPECT_EQ( 0u,
+               steadyStateAllocations(
+                   [&]() { EXPECT_EQ( trimmedSize, caffa::StringTools::trim_view( longText ).size() ); } ) );
+
+    std::string key = longText;
+    EXPECT_EQ( 0u, steadyStateAllocations( [&]() { caffa::StringTools::tolower_in_place( key ); } ) );
+    EXPECT_EQ( 0u, steadyStateAllocations( [&]() { caffa::StringTools::toupper_in_place( key ); } ) );
+    EXPECT_EQ( 0u,
+               steadyStateAllocations(
+                   [&]()
+                   {
+                       EXPECT_TRUE( caffa::StringTools::iequals( key, longText ) );
+                       EXPECT_EQ( caffa::StringTools::ihash( key ), caffa::StringTools::ihash( longText ) );
+                       EXPECT_NE( std::string::npos, caffa::StringTools::ifind( longText, "SMALL STRING" ) );
+                   } ) );
+}
+
+TEST_F( TestAllocations, uuids )
+{
+    const auto uuid = caffa::UuidGenerator::generate();
+
+    // The returned string
+    EXPECT_LE( steadyStateAllocations( []() { EXPECT_EQ( 36u, caffa::UuidGenerator::generate().size() ); } ), 1u );
+    EXPECT_LE( steadyStateAllocations( [&uuid]() { caffa::UuidGenerator::isUuid( uuid ); } ), 1u );
+    // Plus the exception thrown by the boost parser
+    EXPECT_LE( steadyStateAllocations( []() { caffa::UuidGenerator::isUuid( "not a uuid" ); } ), 2u );
+}
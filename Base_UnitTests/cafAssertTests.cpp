@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include "cafAssert.h"
+
+#include <vector>
+
+namespace
+{
+bool isSorted( const std::vector<int>& values )
+{
+    for ( size_t i = 1; i < values.size(); ++i )
+    {
+        if ( values[i - 1] > values[i] ) return false;
+    }
+    return true;
+}
+} // namespace
+
+TEST( TestAssert, passingAssertionsDoNothing )
+{
+    std::vector<int> values = { 1, 2, 3 };
+    CAFFA_ASSERT( !values.empty() );
+    CAFFA_ASSERT_AUDIT( isSorted( values ) );
+}
+
+#if CAFFA_ASSERT_LEVEL >= CAFFA_ASSERT_LEVEL_DEFAULT
+TEST( TestAssert, failedAssertionAbortsWithLocation )
+{
+    // The message goes to the default logger, which writes to standard output rather than the error stream
+    int value = 1;
+    EXPECT_DEATH( CAFFA_ASSERT( value == 2 ), "" );
+}
+#endif
+
+TEST( TestAssert, auditAssertionsOnlyCheckedAtAuditLevel )
+{
+    std::vector<int> values = { 3, 2, 1 };
+#if CAFFA_ASSERT_LEVEL >= CAFFA_ASSERT_LEVEL_AUDIT
+    EXPECT_DEATH( CAFFA_ASSERT_AUDIT( isSorted( values ) ), "" );
+#else
+    int evaluations = 0;
+    CAFFA_ASSERT_AUDIT( ++evaluations > 0 && isSorted( values ) );
+    EXPECT_EQ( 0, evaluations );
+#endif
+}
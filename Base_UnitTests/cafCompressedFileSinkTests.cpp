@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include "cafCompressedFileSink.h"
+#include "cafLogger.h"
+
+#include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/spdlog.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+TEST( TestCompressedFileSink, compressedRotatingFiles )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaCompressedFileSinkTest";
+    std::filesystem::remove_all( directory );
+    auto logFile = ( directory / "compressed.zst" ).string();
+
+    constexpr size_t maxFileSize = 16u * 1024u;
+    {
+        auto sink = std::make_shared<caffa::CompressedRotatingFileSink>( logFile, maxFileSize, 2u, 4096u );
+        sink->set_pattern( "%v" );
+        caffa::Logger::registerCustomSink( "test.compressed", sink );
+
+        // Random digits, so the records compress, but not to nothing
+        std::mt19937 random( 42 );
+        for ( size_t i = 0; i < 5000u; ++i )
+        {
+            caffa::Logger::log( "test.compressed",
+                                caffa::Logger::Level::info,
+                                "record " + std::to_string( i ) + " " + std::to_string( random() ) );
+        }
+        spdlog::drop( "test.compressed" );
+    }
+
+    auto rotatedFile = spdlog::sinks::rotating_file_sink_st::calc_filename( logFile, 1u );
+    ASSERT_TRUE( std::filesystem::exists( rotatedFile ) );
+    ASSERT_TRUE( std::filesystem::exists( spdlog::sinks::rotating_file_sink_st::calc_filename( logFile, 2u ) ) );
+    ASSERT_FALSE( std::filesystem::exists( spdlog::sinks::rotating_file_sink_st::calc_filename( logFile, 3u ) ) );
+
+    for ( const auto& file : { logFile, rotatedFile } )
+    {
+        ASSERT_LE( std::filesystem::file_size( file ), maxFileSize );
+
+        // The index covers the whole file, frame by frame
+        auto     index              = caffa::CompressedRotatingFileSink::readFrameIndex( file );
+        uint64_t compressedOffset   = 0u;
+        uint64_t uncompressedOffset = 0u;
+        ASSERT_FALSE( index.empty() );
+        for ( const auto& entry : index )
+        {
+            ASSERT_EQ( compressedOffset, entry.compressedOffset );
+            ASSERT_EQ( uncompressedOffset, entry.uncompressedOffset );
+            ASSERT_LE( entry.firstTimestamp, entry.lastTimestamp );
+            compressedOffset += entry.compressedSize;
+            uncompressedOffset += entry.uncompressedSize;
+        }
+        ASSERT_EQ( compressedOffset, std::filesystem::file_size( file ) );
+
+        auto records = caffa::CompressedRotatingFileSink::decompress( file );
+        ASSERT_EQ( uncompressedOffset, records.size() );
+        ASSERT_EQ( '\n', records.back() );
+    }
+
+    // The current file holds the last records, ending with the final one
+    auto records = caffa::CompressedRotatingFileSink::decompress( logFile );
+    ASSERT_NE( std::string::npos, records.find( "record 4999 " ) );
+    ASSERT_EQ( std::string::npos, records.find( "record 0 " ) );
+
+    // Nothing was logged after now
+    auto future = std::chrono::system_clock::now() + std::chrono::hours( 1 );
+    ASSERT_TRUE( caffa::CompressedRotatingFileSink::decompress( logFile, future ).empty() );
+
+    std::filesystem::remove_all( directory );
+}
+
+namespace
+{
+void logRecord( caffa::CompressedRotatingFileSink& sink, const std::string& text )
+{
+    sink.log( spdlog::details::log_msg( "test", spdlog::level::err, text ) );
+}
+} // namespace
+
+TEST( TestCompressedFileSink, flushWritesOpenFrame )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaCompressedFileSinkFlushTest";
+    std::filesystem::remove_all( directory );
+    auto logFile = ( directory / "compressed.zst" ).string();
+
+    caffa::CompressedRotatingFileSink sink( logFile, 1024u * 1024u, 1u, 1024u * 1024u, std::chrono::hours( 1 ) );
+    sink.set_pattern( "%v" );
+    logRecord( sink, "the error" );
+    sink.flush();
+
+    // Written and readable while the sink is still open
+    ASSERT_EQ( "the error\n", caffa::CompressedRotatingFileSink::decompress( logFile ) );
+
+    std::filesystem::remove_all( directory );
+}
+
+TEST( TestCompressedFileSink, reopensAfterFailedRotation )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaCompressedFileSinkReopenTest";
+    std::filesystem::remove_all( directory );
+    auto logFile = ( directory / "compressed.zst" ).string();
+
+    // Every frame after the first rotates
+    caffa::CompressedRotatingFileSink sink( logFile, 1u, 1u );
+    sink.set_pattern( "%v" );
+    logRecord( sink, "first" );
+    sink.flush();
+
+    // A file in place of the directory makes the rotation fail
+    std::filesystem::remove_all( directory );
+    std::ofstream( directory ) << "blocking";
+    logRecord( sink, "lost" );
+    sink.flush();
+    EXPECT_EQ( 1u, sink.droppedCount() );
+
+    std::filesystem::remove( directory );
+    logRecord( sink, "last" );
+    sink.flush();
+    EXPECT_EQ( 1u, sink.droppedCount() );
+    ASSERT_EQ( "last\n", caffa::CompressedRotatingFileSink::decompress( logFile ) );
+
+    std::filesystem::remove_all( directory );
+}
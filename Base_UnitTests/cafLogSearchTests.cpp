@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "cafLogSearch.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+std::string record( int second, const std::string& level, const std::string& message )
+{
+    char prefix[64];
+    std::snprintf( prefix, sizeof( prefix ), "[2024-03-01 12:%02d:%02d.000] [test] [", second / 60, second % 60 );
+    return std::string( prefix ) + level + "] " + message + "\n";
+}
+} // namespace
+
+TEST( TestLogSearch, searchRotatedFiles )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaLogSearchTest";
+    std::filesystem::remove_all( directory );
+    std::filesystem::create_directories( directory );
+    auto logFile = ( directory / "search.log" ).string();
+
+    // The rotated file holds the older records
+    {
+        std::ofstream older( ( directory / "search.1.log" ).string() );
+        for ( int second = 0; second < 1000; ++second )
+        {
+            older << record( second, second % 100 == 0 ? "error" : "debug", "older " + std::to_string( second ) );
+        }
+        std::ofstream current( logFile );
+        for ( int second = 1000; second < 2000; ++second )
+        {
+            current << record( second, "info", "current " + std::to_string( second ) );
+        }
+        current << "  continued line with needle\n";
+    }
+
+    caffa::LogSearch search( logFile, 1024u );
+    ASSERT_EQ( 2u, search.files().size() );
+
+    caffa::LogSearch::Query query;
+    query.from = caffa::LogSearch::parseTimestamp( "2024-03-01 12:16:30" );
+    query.to   = caffa::LogSearch::parseTimestamp( "2024-03-01 12:16:49.000" );
+    auto range = search.search( query );
+    ASSERT_EQ( 20u, range.size() );
+    ASSERT_NE( std::string_view::npos, range.front().record.find( "older 990" ) );
+    ASSERT_NE( std::string_view::npos, range.back().record.find( "current 1009" ) );
+
+    caffa::LogSearch::Query errors;
+    errors.minimumLevel = caffa::Logger::Level::err;
+    auto errorMatches   = search.search( errors );
+    ASSERT_EQ( 10u, errorMatches.size() );
+    ASSERT_EQ( caffa::Logger::Level::err, errorMatches.front().level );
+
+    errors.text  = "older 9";
+    errorMatches = search.search( errors );
+    ASSERT_EQ( 1u, errorMatches.size() );
+    ASSERT_NE( std::string_view::npos, errorMatches.front().record.find( "older 900" ) );
+
+    caffa::LogSearch::Query text;
+    text.text        = "needle";
+    auto textMatches = search.search( text );
+    ASSERT_EQ( 1u, textMatches.size() );
+    ASSERT_NE( std::string_view::npos, textMatches.front().record.find( "current 1999\n  continued" ) );
+
+    text.text       = "current 15";
+    text.maxResults = 5u;
+    ASSERT_EQ( 5u, search.search( text ).size() );
+
+    std::filesystem::remove_all( directory );
+}
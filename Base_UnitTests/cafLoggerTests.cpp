@@ -0,0 +1,549 @@
+#include "gtest/gtest.h"
+
+#include "cafLogger.h"
+#include "cafQueuedSink.h"
+#include "cafStringTools.h"
+
+#include "spdlog/sinks/base_sink.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/spdlog.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+CAFFA_LOG_CATEGORY_MINIMUM_LEVEL( "test.stripped", caffa::Logger::Level::warn );
+
+namespace
+{
+int evaluations = 0;
+
+std::string countedMessage( const std::string& text )
+{
+    evaluations++;
+    return text;
+}
+
+class StalledSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::atomic<bool>   stalled = true;
+    std::atomic<bool>   started = false;
+    std::atomic<size_t> count   = 0u;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& ) override
+    {
+        started = true;
+        while ( stalled )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        count++;
+    }
+    void flush_() override {}
+};
+
+class PayloadSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<const char*> payloadData;
+    std::vector<std::string> payloads;
+    std::thread::id          threadId;
+    std::atomic<size_t>      count = 0u;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& msg ) override
+    {
+        threadId = std::this_thread::get_id();
+        payloadData.push_back( msg.payload.data() );
+        payloads.emplace_back( msg.payload.data(), msg.payload.size() );
+        count++;
+    }
+    void flush_() override {}
+};
+
+class ThrowingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+    void sink_it_( const spdlog::details::log_msg& ) override { throw std::runtime_error( "sink failed" ); }
+    void flush_() override {}
+};
+
+void logFromCallSites()
+{
+    CAFFA_DEBUG_SINK( "test.callsite", countedMessage( "debug" ) );
+    CAFFA_INFO_SINK( "test.callsite", countedMessage( "info" ) );
+}
+} // namespace
+
+TEST( TestLogger, categoryLogging )
+{
+    std::ostringstream stream;
+    auto               sink = std::make_shared<spdlog::sinks::ostream_sink_mt>( stream );
+    sink->set_pattern( "%l %v" );
+    caffa::Logger::registerCustomSink( "test.category", sink );
+    caffa::Logger::setLogLevel( "test.category", caffa::Logger::Level::debug );
+
+    evaluations = 0;
+    CAFFA_LOG( "test.category", caffa::Logger::Level::info, countedMessage( "visible" ) );
+    CAFFA_LOG( "test.category", caffa::Logger::Level::trace, countedMessage( "filtered at runtime" ) );
+    ASSERT_EQ( 1, evaluations );
+    ASSERT_EQ( "info visible\n", stream.str() );
+}
+
+TEST( TestLogger, categoryStrippedAtCompileTime )
+{
+    static_assert( !caffa::isLogCategoryEnabled<"test.stripped">( caffa::Logger::Level::info ) );
+    static_assert( caffa::isLogCategoryEnabled<"test.stripped">( caffa::Logger::Level::err ) );
+    static_assert( !caffa::isLogCategoryEnabled<"test.stripped">( caffa::Logger::Level::off ) );
+
+    std::ostringstream stream;
+    auto               sink = std::make_shared<spdlog::sinks::ostream_sink_mt>( stream );
+    sink->set_pattern( "%v" );
+    caffa::Logger::registerCustomSink( "test.stripped", sink );
+    caffa::Logger::setLogLevel( "test.stripped", caffa::Logger::Level::trace );
+
+    evaluations = 0;
+    CAFFA_LOG( "test.stripped", caffa::Logger::Level::debug, countedMessage( "stripped" ) );
+    CAFFA_LOG( "test.stripped", caffa::Logger::Level::err, countedMessage( "kept" ) );
+    ASSERT_EQ( 1, evaluations );
+    ASSERT_EQ( "kept\n", stream.str() );
+}
+
+TEST( TestLogger, messagesFilteredBySinkLevelAreNotBuilt )
+{
+    std::ostringstream stream;
+    auto               sink = std::make_shared<spdlog::sinks::ostream_sink_mt>( stream );
+    sink->set_pattern( "%l %v" );
+    caffa::Logger::registerCustomSink( "test.effective", sink );
+    caffa::Logger::setLogLevel( "test.effective", caffa::Logger::Level::debug );
+    caffa::Logger::setSinkLevel( sink, caffa::Logger::Level::warn );
+
+    ASSERT_FALSE( caffa::Logger::shouldLog( "test.effective", caffa::Logger::Level::info ) );
+    ASSERT_TRUE( caffa::Logger::shouldLog( "test.effective", caffa::Logger::Level::warn ) );
+
+    evaluations = 0;
+    CAFFA_DEBUG_SINK( "test.effective", countedMessage( "debug" ) );
+    CAFFA_WARNING_SINK( "test.effective", countedMessage( "warning" ) );
+    ASSERT_EQ( 1, evaluations );
+    ASSERT_EQ( "warning warning\n", stream.str() );
+
+    caffa::Logger::setSinkLevel( sink, caffa::Logger::Level::debug );
+    CAFFA_DEBUG_SINK( "test.effective", countedMessage( "debug" ) );
+    ASSERT_EQ( 2, evaluations );
+
+    spdlog::drop( "test.effective" );
+}
+
+TEST( TestLogger, callSitesSwitchedAtRuntime )
+{
+    std::ostringstream stream;
+    auto               sink = std::make_shared<spdlog::sinks::ostream_sink_mt>( stream );
+    sink->set_pattern( "%l %v" );
+    caffa::Logger::registerCustomSink( "test.callsite", sink );
+    caffa::Logger::setLogLevel( "test.callsite", caffa::Logger::Level::info );
+
+    logFromCallSites();
+    ASSERT_EQ( "info info\n", stream.str() );
+
+    int    debugLine  = 0;
+    size_t registered = 0u;
+    for ( auto callSite : caffa::LogCallSite::callSites() )
+    {
+        if ( std::string( callSite->function() ) == "logFromCallSites" )
+        {
+            ASSERT_EQ( "cafLoggerTests", caffa::Logger::simplifyFileName( callSite->file() ) );
+            if ( callSite->level() == caffa::Logger::Level::debug ) debugLine = callSite->line();
+            registered++;
+        }
+    }
+    ASSERT_EQ( 2u, registered );
+    ASSERT_NE( 0, debugLine );
+
+    ASSERT_EQ( 1u,
+               caffa::LogCallSite::setState( "*LoggerTests.cpp", "logFrom*", debugLine, caffa::LogCallSite::State::on ) );
+    stream.str( "" );
+    evaluations = 0;
+    logFromCallSites();
+    ASSERT_EQ( 2, evaluations );
+    ASSERT_EQ( "debug debug\ninfo info\n", stream.str() );
+
+    ASSERT_EQ( 2u, caffa::LogCallSite::setState( "", "logFromCallSites", 0, caffa::LogCallSite::State::off ) );
+    stream.str( "" );
+    evaluations = 0;
+    logFromCallSites();
+    ASSERT_EQ( 0, evaluations );
+    ASSERT_EQ( "", stream.str() );
+
+    ASSERT_EQ( 2u, caffa::LogCallSite::setState( "", "logFromCallSites", 0, caffa::LogCallSite::State::automatic ) );
+    ASSERT_EQ( 0u, caffa::LogCallSite::setState( "noSuchFile.cpp", "", 0, caffa::LogCallSite::State::on ) );
+    stream.str( "" );
+    logFromCallSites();
+    ASSERT_EQ( "info info\n", stream.str() );
+}
+
+TEST( TestLogger, effectiveLevelFollowsRegistration )
+{
+    const auto& defaultLevel = caffa::Logger::effectiveLevelOf( "" );
+
+    // Looked up before the logger exists, as a call site running early would
+    const auto& level = caffa::Logger::effectiveLevelOf( "test.registeredLater" );
+    EXPECT_EQ( defaultLevel.load(), level.load() );
+
+    caffa::Logger::registerCustomSink( "test.registeredLater", std::make_shared<PayloadSink>() );
+    caffa::Logger::setLogLevel( "test.registeredLater", caffa::Logger::Level::err );
+    EXPECT_EQ( caffa::Logger::Level::err, level.load() );
+    EXPECT_FALSE( caffa::Logger::shouldLog( level, caffa::Logger::Level::warn ) );
+    EXPECT_TRUE( caffa::Logger::shouldLog( "test.registeredLater", caffa::Logger::Level::err ) );
+
+    spdlog::drop( "test.registeredLater" );
+    caffa::Logger::refreshEffectiveLevels();
+    EXPECT_EQ( defaultLevel.load(), level.load() );
+}
+
+TEST( TestLogger, concurrentLevelChangesPublishLatestLevel )
+{
+    auto sink = std::make_shared<PayloadSink>();
+    caffa::Logger::registerCustomSink( "test.concurrentLevels", sink );
+
+    for ( int round = 0; round < 200; ++round )
+    {
+        std::thread verbose( []()
+                             { caffa::Logger::setLogLevel( "test.concurrentLevels", caffa::Logger::Level::trace ); } );
+        std::thread quiet( []()
+                           { caffa::Logger::setLogLevel( "test.concurrentLevels", caffa::Logger::Level::off ); } );
+        verbose.join();
+        quiet.join();
+
+        // Whichever change came last, the published level has to agree with the logger
+        bool loggerAllowsInfo = spdlog::get( "test.concurrentLevels" )->should_log( spdlog::level::info );
+        ASSERT_EQ( loggerAllowsInfo, caffa::Logger::shouldLog( "test.concurrentLevels", caffa::Logger::Level::info ) );
+    }
+    spdlog::drop( "test.concurrentLevels" );
+}
+
+TEST( TestLogger, queuedSinkDoesNotStallOtherSinks )
+{
+    std::ostringstream stream;
+    auto               fastSink = std::make_shared<spdlog::sinks::ostream_sink_mt>( stream );
+    fastSink->set_pattern( "%v" );
+    auto slowSink = std::make_shared<StalledSink>();
+
+    caffa::Logger::registerCustomSink( "test.queued", fastSink );
+    caffa::Logger::registerQueuedSink( "test.queued", slowSink, 4u, caffa::Logger::OverflowPolicy::discardNew );
+
+    constexpr size_t messageCount = 20u;
+    for ( size_t i = 0; i < messageCount; ++i )
+    {
+        caffa::Logger::log( "test.queued", caffa::Logger::Level::info, std::to_string( i ) );
+    }
+    ASSERT_EQ( messageCount, caffa::StringTools::split( stream.str(), "\n", true ).size() );
+
+    // One record is held by the stalled worker, four are queued and the rest are dropped
+    ASSERT_LE( messageCount - 5u, caffa::Logger::droppedMessages( "test.queued" ) );
+
+    slowSink->stalled = false;
+    spdlog::drop( "test.queued" );
+}
+
+TEST( TestLogger, directRecordsKeepBacktraceAndErrorHandler )
+{
+    auto sink = std::make_shared<PayloadSink>();
+    caffa::Logger::registerCustomSink( "test.direct", std::make_shared<ThrowingSink>() );
+    caffa::Logger::registerQueuedSink( "test.direct", sink, 16u, caffa::Logger::OverflowPolicy::block );
+    caffa::Logger::setLogLevel( "test.direct", caffa::Logger::Level::info );
+
+    std::vector<std::string> errors;
+    auto                     logger = spdlog::get( "test.direct" );
+    logger->set_error_handler( [&errors]( const std::string& error ) { errors.push_back( error ); } );
+    logger->enable_backtrace( 8u );
+
+    // Moved into the queued sink, forced past the logger level and forced without moving
+    caffa::Logger::log( "test.direct", caffa::Logger::Level::info, std::string( "moved" ) );
+    caffa::Logger::log( "test.direct", caffa::Logger::Level::debug, std::string( "forced" ), true );
+    caffa::Logger::log( "test.direct", caffa::Logger::Level::debug, std::string_view( "viewed" ), true );
+    EXPECT_EQ( 3u, errors.size() );
+
+    errors.clear();
+    logger->dump_backtrace();
+    spdlog::drop( "test.direct" );
+    logger.reset();
+
+    // All three records again from the backtrace, with the throwing sink reporting each of them
+    for ( const char* text : { "moved", "forced", "viewed" } )
+    {
+        EXPECT_EQ( 2, std::count( sink->payloads.begin(), sink->payloads.end(), text ) ) << text;
+    }
+    EXPECT_LE( 3u, errors.size() );
+}
+
+TEST( TestLogger, queuedSinkTakesOverMovedMessages )
+{
+    auto sink = std::make_shared<PayloadSink>();
+    caffa::Logger::registerQueuedSink( "test.moved", sink, 16u, caffa::Logger::OverflowPolicy::block );
+
+    std::string movedMessage( 100u, 'm' );
+    const char* movedData = movedMessage.data();
+    caffa::Logger::log( "test.moved", caffa::Logger::Level::info, std::move( movedMessage ) );
+
+    std::string copiedMessage( 100u, 'c' );
+    caffa::Logger::log( "test.moved", caffa::Logger::Level::info, copiedMessage );
+    caffa::Logger::log( "test.moved", caffa::Logger::Level::info, std::string_view( "view" ) );
+
+    while ( sink->count < 3u )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_EQ( movedData, sink->payloadData[0] );
+    ASSERT_EQ( std::string( 100u, 'm' ), sink->payloads[0] );
+    ASSERT_NE( copiedMessage.data(), sink->payloadData[1] );
+    ASSERT_EQ( copiedMessage, sink->payloads[1] );
+    ASSERT_EQ( "view", sink->payloads[2] );
+    spdlog::drop( "test.moved" );
+}
+
+TEST( TestLogger, queuedSinkUsesLevelOfWrappedSink )
+{
+    auto sink = std::make_shared<PayloadSink>();
+    caffa::Logger::registerQueuedSink( "test.wrappedLevel", sink, 16u, caffa::Logger::OverflowPolicy::block );
+    caffa::Logger::setLogLevel( "test.wrappedLevel", caffa::Logger::Level::info );
+
+    // Set on the wrapped sink, which the effective level has to take into account
+    caffa::Logger::setSinkLevel( sink, caffa::Logger::Level::warn );
+    ASSERT_FALSE( caffa::Logger::shouldLog( "test.wrappedLevel", caffa::Logger::Level::info ) );
+    ASSERT_TRUE( caffa::Logger::shouldLog( "test.wrappedLevel", caffa::Logger::Level::warn ) );
+
+    // Records handed straight to the queued sink are filtered by the worker
+    auto queuedSink = std::dynamic_pointer_cast<caffa::QueuedSink>( spdlog::get( "test.wrappedLevel" )->sinks().back() );
+    ASSERT_TRUE( queuedSink );
+    EXPECT_EQ( spdlog::level::warn, queuedSink->level() );
+    queuedSink->spdlog::sinks::sink::set_level( spdlog::level::trace );
+    queuedSink->log( spdlog::details::log_msg( "test.wrappedLevel", spdlog::level::info, "info" ) );
+    queuedSink->log( spdlog::details::log_msg( "test.wrappedLevel", spdlog::level::warn, "warning" ) );
+
+    while ( sink->count < 1u )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    spdlog::drop( "test.wrappedLevel" );
+    queuedSink.reset();
+    EXPECT_EQ( std::vector<std::string>{ "warning" }, sink->payloads );
+}
+
+TEST( TestLogger, asyncLoggersKeepOrderPerLogger )
+{
+    caffa::Logger::enableAsyncLogging( 2u, 64u, caffa::Logger::OverflowPolicy::block );
+
+    constexpr size_t                          loggerCount  = 4u;
+    constexpr size_t                          messageCount = 1000u;
+    std::vector<std::shared_ptr<PayloadSink>> sinks;
+    for ( size_t i = 0; i < loggerCount; ++i )
+    {
+        sinks.push_back( std::make_shared<PayloadSink>() );
+        caffa::Logger::registerCustomSink( "test.async" + std::to_string( i ), sinks.back() );
+    }
+    caffa::Logger::enableAsyncLogging( 0u );
+
+    for ( size_t message = 0; message < messageCount; ++message )
+    {
+        for ( size_t i = 0; i < loggerCount; ++i )
+        {
+            caffa::Logger::log( "test.async" + std::to_string( i ),
+                                caffa::Logger::Level::info,
+                                std::to_string( message ) );
+        }
+    }
+    caffa::Logger::setLogLevel( "test.async0", caffa::Logger::Level::warn );
+    caffa::Logger::log( "test.async0", caffa::Logger::Level::debug, "filtered" );
+    caffa::Logger::log( "test.async0", caffa::Logger::Level::debug, "forced", true );
+
+    for ( auto& sink : sinks )
+    {
+        while ( sink->count < messageCount )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+    }
+    while ( sinks[0]->count < messageCount + 1u )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    for ( auto& sink : sinks )
+    {
+        for ( size_t message = 0; message < messageCount; ++message )
+        {
+            ASSERT_EQ( std::to_string( message ), sink->payloads[message] );
+        }
+        ASSERT_NE( std::this_thread::get_id(), sink->threadId );
+    }
+    ASSERT_EQ( "forced", sinks[0]->payloads.back() );
+    ASSERT_EQ( sinks[0]->threadId, sinks[2]->threadId );
+    ASSERT_NE( sinks[0]->threadId, sinks[1]->threadId );
+
+    for ( size_t i = 0; i < loggerCount; ++i )
+    {
+        spdlog::drop( "test.async" + std::to_string( i ) );
+    }
+}
+
+TEST( TestLogger, queuedSinkShedsLowerLevelsFirst )
+{
+    auto slowSink = std::make_shared<StalledSink>();
+    caffa::Logger::registerQueuedSink( "test.shedding", slowSink, 10u, caffa::Logger::OverflowPolicy::shedByLevel );
+    caffa::Logger::setLogLevel( "test.shedding", caffa::Logger::Level::trace );
+
+    // Get the worker stuck on the first record so the queue is empty
+    caffa::Logger::log( "test.shedding", caffa::Logger::Level::info, "first" );
+    while ( !slowSink->started )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        caffa::Logger::log( "test.shedding", caffa::Logger::Level::debug, "debug" );
+    }
+    for ( int i = 0; i < 10; ++i )
+    {
+        caffa::Logger::log( "test.shedding", caffa::Logger::Level::err, "error" );
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+        caffa::Logger::log( "test.shedding", caffa::Logger::Level::critical, "critical" );
+    }
+
+    // Debug is shed beyond 60% fill, error only when full and critical overruns the oldest debug records
+    auto dropped = caffa::Logger::droppedMessagesPerLevel( "test.shedding" );
+    ASSERT_EQ( 14u + 3u, dropped[caffa::Logger::Level::debug] );
+    ASSERT_EQ( 6u, dropped[caffa::Logger::Level::err] );
+    ASSERT_EQ( 0u, dropped[caffa::Logger::Level::critical] );
+    ASSERT_EQ( 23u, caffa::Logger::droppedMessages( "test.shedding" ) );
+
+    slowSink->stalled = false;
+    spdlog::drop( "test.shedding" );
+    ASSERT_EQ( 11u, slowSink->count );
+}
+
+#ifdef __linux__
+namespace
+{
+class AffinitySink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::atomic<int> cpuCount = 0;
+    std::atomic<int> firstCpu = -1;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& ) override
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        pthread_getaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet );
+        cpuCount = CPU_COUNT( &cpuSet );
+        for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+        {
+            if ( CPU_ISSET( cpu, &cpuSet ) )
+            {
+                firstCpu = cpu;
+                break;
+            }
+        }
+    }
+    void flush_() override {}
+};
+} // namespace
+
+TEST( TestLogger, queuedSinkWorkerIsPinned )
+{
+    caffa::ThreadConfiguration configuration;
+    configuration.cpus = { 0u };
+    caffa::Logger::setWorkerThreadConfiguration( caffa::Logger::WorkerThread::queuedSink, configuration );
+
+    auto sink = std::make_shared<AffinitySink>();
+    caffa::Logger::registerQueuedSink( "test.pinned", sink );
+    caffa::Logger::setWorkerThreadConfiguration( caffa::Logger::WorkerThread::queuedSink, caffa::ThreadConfiguration() );
+
+    caffa::Logger::log( "test.pinned", caffa::Logger::Level::info, "pinned" );
+    spdlog::drop( "test.pinned" );
+
+    ASSERT_EQ( 1, sink->cpuCount );
+    ASSERT_EQ( 0, sink->firstCpu );
+}
+
+TEST( TestLogger, outOfRangeCpuIsAnError )
+{
+    caffa::ThreadConfiguration configuration;
+    configuration.cpus = { 1u << 20u };
+    ASSERT_FALSE( configuration.applyToCurrentThread() );
+
+    cpu_set_t cpuSet;
+    ASSERT_EQ( 0, pthread_getaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet ) );
+    ASSERT_GT( CPU_COUNT( &cpuSet ), 0 );
+}
+
+TEST( TestLogger, asyncLoggerWorkerIsPinned )
+{
+    caffa::ThreadConfiguration configuration;
+    configuration.cpus = { 0u };
+    caffa::Logger::setWorkerThreadConfiguration( caffa::Logger::WorkerThread::asyncLogger, configuration );
+    caffa::Logger::enableAsyncLogging( 1u, 64u, caffa::Logger::OverflowPolicy::block );
+    caffa::Logger::setWorkerThreadConfiguration( caffa::Logger::WorkerThread::asyncLogger, caffa::ThreadConfiguration() );
+
+    auto sink = std::make_shared<AffinitySink>();
+    caffa::Logger::registerCustomSink( "test.asyncPinned", sink );
+    caffa::Logger::enableAsyncLogging( 0u );
+
+    caffa::Logger::log( "test.asyncPinned", caffa::Logger::Level::info, "pinned" );
+    while ( sink->cpuCount == 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    spdlog::drop( "test.asyncPinned" );
+
+    ASSERT_EQ( 1, sink->cpuCount );
+    ASSERT_EQ( 0, sink->firstCpu );
+}
+namespace
+{
+size_t threadCount()
+{
+    auto tasks = std::filesystem::directory_iterator( "/proc/self/task" );
+    return static_cast<size_t>( std::distance( std::filesystem::begin( tasks ), std::filesystem::end( tasks ) ) );
+}
+} // namespace
+
+TEST( TestLogger, unusedAsyncWorkersAreStopped )
+{
+    // Stops the workers left unused by earlier tests
+    caffa::Logger::enableAsyncLogging( 0u );
+    const size_t baseline = threadCount();
+
+    caffa::Logger::enableAsyncLogging( 2u, 64u );
+    EXPECT_EQ( baseline + 2u, threadCount() );
+
+    auto sink = std::make_shared<PayloadSink>();
+    caffa::Logger::registerCustomSink( "test.asyncRetired", sink );
+
+    // Only the worker of the logger is kept
+    caffa::Logger::enableAsyncLogging( 0u );
+    EXPECT_EQ( baseline + 1u, threadCount() );
+
+    caffa::Logger::log( "test.asyncRetired", caffa::Logger::Level::info, "still served" );
+    spdlog::drop( "test.asyncRetired" );
+    caffa::Logger::enableAsyncLogging( 0u );
+    EXPECT_EQ( baseline, threadCount() );
+    EXPECT_EQ( std::vector<std::string>{ "still served" }, sink->payloads );
+}
+#endif
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include "cafMetrics.h"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST( TestMetrics, countersSumAcrossThreads )
+{
+    auto& counter = caffa::Metrics::counter( "test_counter_total", "Test counter" );
+    EXPECT_EQ( &counter, &caffa::Metrics::counter( "test_counter_total" ) );
+
+    std::vector<std::thread> threads;
+    for ( int thread = 0; thread < 4; ++thread )
+    {
+        threads.emplace_back(
+            [&counter]()
+            {
+                for ( int i = 0; i < 10000; ++i )
+                {
+                    counter.increment();
+                }
+            } );
+    }
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+    counter.increment( 5u );
+    EXPECT_EQ( 40005u, counter.value() );
+}
+
+TEST( TestMetrics, gauges )
+{
+    auto& gauge = caffa::Metrics::gauge( "test_gauge" );
+    gauge.set( 10.0 );
+    gauge.add( 2.5 );
+    gauge.subtract( 0.5 );
+    EXPECT_DOUBLE_EQ( 12.0, gauge.value() );
+}
+
+TEST( TestMetrics, histogramBuckets )
+{
+    for ( uint64_t value : { 0u, 1u, 15u, 16u, 17u, 100u, 1000u, 123456789u } )
+    {
+        auto index = caffa::MetricHistogram::bucketIndex( value );
+        EXPECT_LE( value, caffa::MetricHistogram::bucketUpperBound( index ) );
+        EXPECT_LE( caffa::MetricHistogram::bucketUpperBound( index ) - value, value / 16u );
+        if ( index > 0u )
+        {
+            EXPECT_LT( caffa::MetricHistogram::bucketUpperBound( index - 1u ), value );
+        }
+    }
+    EXPECT_EQ( caffa::MetricHistogram::BUCKET_COUNT - 1u,
+               caffa::MetricHistogram::bucketIndex( std::numeric_limits<uint64_t>::max() ) );
+    EXPECT_EQ( std::numeric_limits<uint64_t>::max(),
+               caffa::MetricHistogram::bucketUpperBound( caffa::MetricHistogram::BUCKET_COUNT - 1u ) );
+
+    auto& histogram = caffa::Metrics::histogram( "test_histogram_nanoseconds" );
+    for ( uint64_t value = 1u; value <= 1000u; ++value )
+    {
+        histogram.record( value );
+    }
+    EXPECT_EQ( 1000u, histogram.count() );
+    EXPECT_EQ( 500500u, histogram.sum() );
+    EXPECT_NEAR( 500.0, static_cast<double>( histogram.quantile( 0.5 ) ), 500.0 / 16.0 );
+    EXPECT_NEAR( 990.0, static_cast<double>( histogram.quantile( 0.99 ) ), 990.0 / 16.0 );
+}
+
+TEST( TestMetrics, invalidNamesAndTypeClashes )
+{
+    EXPECT_THROW( caffa::Metrics::counter( "1_invalid" ), std::invalid_argument );
+    EXPECT_THROW( caffa::Metrics::counter( "has space" ), std::invalid_argument );
+    EXPECT_THROW( caffa::Metrics::counter( "caf\xe9" ), std::invalid_argument );
+
+    caffa::Metrics::gauge( "test_clash" );
+    EXPECT_THROW( caffa::Metrics::counter( "test_clash" ), std::invalid_argument );
+    EXPECT_THROW( caffa::Metrics::histogram( "test_clash" ), std::invalid_argument );
+}
+
+TEST( TestMetrics, prometheusText )
+{
+    caffa::Metrics::counter( "test_export_requests_total", "Requests\nhandled" ).increment( 3u );
+    auto& histogram = caffa::Metrics::histogram( "test_export_bytes" );
+    histogram.record( 10u );
+    histogram.record( 100u );
+
+    auto text = caffa::Metrics::prometheusText();
+    EXPECT_NE( std::string::npos, text.find( "# HELP test_export_requests_total Requests\\nhandled\n" ) );
+    EXPECT_NE( std::string::npos,
+               text.find( "# TYPE test_export_requests_total counter\ntest_export_requests_total 3\n" ) );
+    EXPECT_NE( std::string::npos, text.find( "test_export_bytes_bucket{le=\"10\"} 1\n" ) );
+    EXPECT_NE( std::string::npos, text.find( "test_export_bytes_bucket{le=\"+Inf\"} 2\n" ) );
+    EXPECT_NE( std::string::npos, text.find( "test_export_bytes_sum 110\ntest_export_bytes_count 2\n" ) );
+}
+
+TEST( TestMetrics, specialGaugeValues )
+{
+    caffa::Metrics::gauge( "test_export_nan" ).set( std::numeric_limits<double>::quiet_NaN() );
+    caffa::Metrics::gauge( "test_export_infinity" ).set( std::numeric_limits<double>::infinity() );
+    caffa::Metrics::gauge( "test_export_negative_infinity" ).set( -std::numeric_limits<double>::infinity() );
+
+    auto text = caffa::Metrics::prometheusText();
+    EXPECT_NE( std::string::npos, text.find( "\ntest_export_nan NaN\n" ) );
+    EXPECT_NE( std::string::npos, text.find( "\ntest_export_infinity +Inf\n" ) );
+    EXPECT_NE( std::string::npos, text.find( "\ntest_export_negative_infinity -Inf\n" ) );
+}
+
+TEST( TestMetrics, periodicWrite )
+{
+    auto file = ( std::filesystem::temp_directory_path() / "caffaMetricsTest.prom" ).string();
+    std::filesystem::remove( file );
+
+    caffa::Metrics::counter( "test_periodic_total" ).increment();
+    caffa::Metrics::startPeriodicWrite( file, std::chrono::milliseconds( 10 ) );
+    for ( int i = 0; i < 200 && !std::filesystem::exists( file ); ++i )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    caffa::Metrics::stopPeriodicWrite();
+
+    std::ifstream     stream( file );
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    EXPECT_NE( std::string::npos, contents.str().find( "test_periodic_total 1\n" ) );
+
+    std::filesystem::remove( file );
+}
@@ -0,0 +1,232 @@
+#include "gtest/gtest.h"
+
+#include "cafLogger.h"
+#include "cafNetworkSinks.h"
+
+#include "spdlog/spdlog.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/**
+ * A socket bound to an ephemeral loopback port
+ */
+class LoopbackReceiver
+{
+public:
+    LoopbackReceiver( int socketType, uint16_t port = 0u )
+    {
+        m_socket  = ::socket( AF_INET, socketType, 0 );
+        int reuse = 1;
+        ::setsockopt( m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ) );
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        address.sin_port        = htons( port );
+        EXPECT_EQ( 0, ::bind( m_socket, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) );
+        if ( socketType == SOCK_STREAM )
+        {
+            EXPECT_EQ( 0, ::listen( m_socket, 1 ) );
+        }
+
+        socklen_t length = sizeof( address );
+        ::getsockname( m_socket, reinterpret_cast<sockaddr*>( &address ), &length );
+        m_port = ntohs( address.sin_port );
+    }
+    ~LoopbackReceiver()
+    {
+        if ( m_connection >= 0 ) ::close( m_connection );
+        ::close( m_socket );
+    }
+
+    uint16_t port() const { return m_port; }
+
+    std::vector<std::string> receiveDatagrams( size_t count )
+    {
+        std::vector<std::string> datagrams;
+        char                     buffer[65536];
+        while ( datagrams.size() < count && waitForData( m_socket ) )
+        {
+            auto length = ::recv( m_socket, buffer, sizeof( buffer ), 0 );
+            if ( length < 0 ) break;
+            datagrams.emplace_back( buffer, static_cast<size_t>( length ) );
+        }
+        return datagrams;
+    }
+
+    std::vector<std::string> receiveFrames( size_t count )
+    {
+        if ( m_connection < 0 && waitForData( m_socket ) )
+        {
+            m_connection = ::accept( m_socket, nullptr, nullptr );
+        }
+
+        std::vector<std::string> frames;
+        std::string              stream;
+        char                     buffer[65536];
+        while ( frames.size() < count && waitForData( m_connection ) )
+        {
+            auto length = ::recv( m_connection, buffer, sizeof( buffer ), 0 );
+            if ( length <= 0 ) break;
+            stream.append( buffer, static_cast<size_t>( length ) );
+
+            while ( stream.size() >= 4u )
+            {
+                uint32_t frameLength = 0u;
+                std::memcpy( &frameLength, stream.data(), 4u );
+                frameLength = ntohl( frameLength );
+                if ( stream.size() < 4u + frameLength ) break;
+                frames.push_back( stream.substr( 4u, frameLength ) );
+                stream.erase( 0u, 4u + frameLength );
+            }
+        }
+        return frames;
+    }
+
+private:
+    static bool waitForData( int socket )
+    {
+        pollfd descriptor{ socket, POLLIN, 0 };
+        return ::poll( &descriptor, 1, 2000 ) > 0;
+    }
+
+    int      m_socket     = -1;
+    int      m_connection = -1;
+    uint16_t m_port       = 0u;
+};
+} // namespace
+
+TEST( TestNetworkSinks, batchedUdpSink )
+{
+    LoopbackReceiver receiver( SOCK_DGRAM );
+
+    auto sink = std::make_shared<caffa::BatchedUdpSink>( "127.0.0.1", receiver.port(), 4u );
+    sink->set_pattern( "%v" );
+    caffa::Logger::registerCustomSink( "test.udp", sink );
+
+    for ( int i = 0; i < 6; ++i )
+    {
+        caffa::Logger::log( "test.udp", caffa::Logger::Level::info, "record " + std::to_string( i ) );
+    }
+
+    // The first batch of four goes out on its own, the rest waits for a flush
+    auto datagrams = receiver.receiveDatagrams( 4u );
+    ASSERT_EQ( 4u, datagrams.size() );
+    ASSERT_EQ( "record 0\n", datagrams[0] );
+    ASSERT_EQ( "record 3\n", datagrams[3] );
+
+    spdlog::get( "test.udp" )->flush();
+    datagrams = receiver.receiveDatagrams( 2u );
+    ASSERT_EQ( 2u, datagrams.size() );
+    ASSERT_EQ( "record 5\n", datagrams[1] );
+    ASSERT_EQ( 0u, sink->droppedCount() );
+
+    spdlog::drop( "test.udp" );
+}
+
+TEST( TestNetworkSinks, batchedUdpSinkTruncatesLongRecords )
+{
+    LoopbackReceiver receiver( SOCK_DGRAM );
+
+    auto sink = std::make_shared<caffa::BatchedUdpSink>( "127.0.0.1", receiver.port(), 2u, 16u );
+    sink->set_pattern( "%v" );
+    caffa::Logger::registerCustomSink( "test.udp.truncated", sink );
+
+    // Two full batches, so the second one goes out on the same message headers
+    caffa::Logger::log( "test.udp.truncated", caffa::Logger::Level::info, "short" );
+    caffa::Logger::log( "test.udp.truncated", caffa::Logger::Level::info, std::string( 100u, 'x' ) );
+    caffa::Logger::log( "test.udp.truncated", caffa::Logger::Level::info, std::string( 16u, 'y' ) );
+    caffa::Logger::log( "test.udp.truncated", caffa::Logger::Level::info, "last" );
+
+    auto datagrams = receiver.receiveDatagrams( 4u );
+    ASSERT_EQ( 4u, datagrams.size() );
+    ASSERT_EQ( "short\n", datagrams[0] );
+    ASSERT_EQ( std::string( 16u, 'x' ), datagrams[1] );
+    ASSERT_EQ( std::string( 16u, 'y' ), datagrams[2] );
+    ASSERT_EQ( "last\n", datagrams[3] );
+    ASSERT_EQ( 0u, sink->droppedCount() );
+
+    spdlog::drop( "test.udp.truncated" );
+}
+
+TEST( TestNetworkSinks, framedTcpSink )
+{
+    LoopbackReceiver receiver( SOCK_STREAM );
+
+    auto sink = std::make_shared<caffa::FramedTcpSink>( "127.0.0.1", receiver.port(), 256u );
+    sink->set_pattern( "%v" );
+    caffa::Logger::registerCustomSink( "test.tcp", sink );
+
+    const std::string longRecord( 1000u, 'x' );
+    for ( int i = 0; i < 100; ++i )
+    {
+        caffa::Logger::log( "test.tcp", caffa::Logger::Level::info, "record " + std::to_string( i ) );
+    }
+    caffa::Logger::log( "test.tcp", caffa::Logger::Level::info, longRecord );
+    spdlog::get( "test.tcp" )->flush();
+
+    auto frames = receiver.receiveFrames( 101u );
+    ASSERT_EQ( 101u, frames.size() );
+    for ( int i = 0; i < 100; ++i )
+    {
+        ASSERT_EQ( "record " + std::to_string( i ) + "\n", frames[i] );
+    }
+    ASSERT_EQ( longRecord + "\n", frames[100] );
+    ASSERT_TRUE( sink->connected() );
+
+    spdlog::drop( "test.tcp" );
+}
+
+TEST( TestNetworkSinks, framedTcpSinkReconnects )
+{
+    uint16_t port = 0u;
+    {
+        LoopbackReceiver unused( SOCK_STREAM );
+        port = unused.port();
+    }
+
+    auto sink = std::make_shared<caffa::FramedTcpSink>( "127.0.0.1",
+                                                        port,
+                                                        64u * 1024u,
+                                                        16u * 1024u * 1024u,
+                                                        std::chrono::milliseconds( 10 ) );
+    sink->set_pattern( "%v" );
+    caffa::Logger::registerCustomSink( "test.tcp.reconnect", sink );
+    auto logger = spdlog::get( "test.tcp.reconnect" );
+
+    // Nobody is listening, so the records are buffered without blocking the caller
+    auto start = std::chrono::steady_clock::now();
+    caffa::Logger::log( "test.tcp.reconnect", caffa::Logger::Level::info, "buffered" );
+    logger->flush();
+    ASSERT_LT( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 500 ) );
+    ASSERT_FALSE( sink->connected() );
+
+    LoopbackReceiver receiver( SOCK_STREAM, port );
+    caffa::Logger::log( "test.tcp.reconnect", caffa::Logger::Level::info, "after reconnect" );
+    for ( int attempt = 0; attempt < 200 && !sink->connected(); ++attempt )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        logger->flush();
+    }
+    ASSERT_TRUE( sink->connected() );
+    logger->flush();
+
+    auto frames = receiver.receiveFrames( 2u );
+    ASSERT_EQ( 2u, frames.size() );
+    ASSERT_EQ( "buffered\n", frames[0] );
+    ASSERT_EQ( "after reconnect\n", frames[1] );
+
+    spdlog::drop( "test.tcp.reconnect" );
+}
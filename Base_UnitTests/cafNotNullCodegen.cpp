@@ -0,0 +1,30 @@
+// Not part of the unit test executable. Compiled to assembly by the caffaBase_NotNullCodegen test,
+// which checks that these functions have no compares, branches or calls left from null checks.
+
+#include "cafNotNull.h"
+
+struct CodegenNode
+{
+    int                                 value;
+    caffa::not_null<const CodegenNode*> next;
+};
+
+extern "C" const int* caffa_codegen_get( caffa::not_null<const int*> pointer )
+{
+    return pointer.get();
+}
+
+extern "C" int caffa_codegen_dereference( caffa::not_null<const int*> pointer )
+{
+    return *pointer;
+}
+
+extern "C" int caffa_codegen_arrow( caffa::not_null<const CodegenNode*> node )
+{
+    return node->value;
+}
+
+extern "C" int caffa_codegen_chase( caffa::not_null<const CodegenNode*> node )
+{
+    return node->next->next->next->value;
+}
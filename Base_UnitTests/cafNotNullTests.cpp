@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include "cafNotNull.h"
+
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+TEST( TestNotNull, threeWayComparison )
+{
+    int                   values[2] = { 1, 2 };
+    caffa::not_null<int*> first( &values[0] );
+    caffa::not_null<int*> second( &values[1] );
+
+    EXPECT_EQ( std::strong_ordering::less, first <=> second );
+    EXPECT_TRUE( first < second );
+    EXPECT_TRUE( second >= first );
+    EXPECT_TRUE( first != second );
+    EXPECT_TRUE( first == caffa::not_null<const int*>( &values[0] ) );
+}
+
+TEST( TestNotNull, comparisonWithPlainPointers )
+{
+    int                   values[2] = { 1, 2 };
+    caffa::not_null<int*> first( &values[0] );
+    const int*            second = &values[1];
+
+    EXPECT_TRUE( first == &values[0] );
+    EXPECT_TRUE( &values[0] == first );
+    EXPECT_TRUE( first != second );
+    EXPECT_TRUE( first < second );
+    EXPECT_TRUE( second > first );
+
+    auto                                   shared = std::make_shared<int>( 3 );
+    caffa::not_null<std::shared_ptr<int>> notNullShared( shared );
+    EXPECT_TRUE( notNullShared == shared );
+    EXPECT_EQ( std::strong_ordering::equal, notNullShared <=> shared );
+}
+
+TEST( TestNotNull, keysInContainers )
+{
+    int values[3] = { 1, 2, 3 };
+
+    std::unordered_set<caffa::not_null<int*>, caffa::not_null_hash<int*>, std::equal_to<>> hashed;
+    hashed.insert( caffa::not_null<int*>( &values[0] ) );
+    hashed.insert( caffa::not_null<int*>( &values[1] ) );
+    EXPECT_NE( hashed.end(), hashed.find( &values[1] ) );
+    EXPECT_EQ( hashed.end(), hashed.find( &values[2] ) );
+    EXPECT_EQ( std::hash<int*>{}( &values[0] ), std::hash<caffa::not_null<int*>>{}( &values[0] ) );
+
+    std::unordered_map<caffa::not_null<std::shared_ptr<int>>, int> byShared;
+    auto                                                           shared = std::make_shared<int>( 4 );
+    byShared[caffa::not_null<std::shared_ptr<int>>( shared )] = 1;
+    EXPECT_EQ( 1, byShared.at( caffa::not_null<std::shared_ptr<int>>( shared ) ) );
+
+    std::set<caffa::not_null<int*>, std::less<>> ordered = { &values[2], &values[0] };
+    EXPECT_EQ( &values[0], *ordered.begin() );
+    EXPECT_NE( ordered.end(), ordered.find( &values[2] ) );
+}
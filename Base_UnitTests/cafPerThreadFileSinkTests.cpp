@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "cafLogger.h"
+#include "cafPerThreadFileSink.h"
+
+#include "spdlog/spdlog.h"
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST( TestPerThreadFileSink, mergedInSequenceOrder )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaPerThreadFileSinkTest";
+    std::filesystem::remove_all( directory );
+    auto logFile = ( directory / "capture.log" ).string();
+
+    constexpr int threadCount  = 4;
+    constexpr int messageCount = 1000;
+    {
+        auto sink = std::make_shared<caffa::PerThreadFileSink>( logFile );
+        sink->set_pattern( "%v" );
+        caffa::Logger::registerCustomSink( "test.perthread", sink );
+
+        std::vector<std::thread> threads;
+        for ( int thread = 0; thread < threadCount; ++thread )
+        {
+            threads.emplace_back(
+                [thread]()
+                {
+                    for ( int i = 0; i < messageCount; ++i )
+                    {
+                        caffa::Logger::log( "test.perthread",
+                                            caffa::Logger::Level::info,
+                                            std::to_string( thread ) + ":" + std::to_string( i ) );
+                    }
+                } );
+        }
+        for ( auto& thread : threads )
+        {
+            thread.join();
+        }
+        spdlog::drop( "test.perthread" );
+    }
+
+    ASSERT_EQ( static_cast<size_t>( threadCount ), caffa::PerThreadFileSink::threadFiles( logFile ).size() );
+
+    uint64_t           expectedSequence = 0u;
+    std::map<int, int> nextMessage;
+    caffa::PerThreadFileSink::merge( logFile,
+                                     [&]( const caffa::PerThreadFileSink::Record& record )
+                                     {
+                                         EXPECT_EQ( expectedSequence++, record.sequence );
+                                         EXPECT_LT( 0, record.timestamp );
+
+                                         auto separator = record.text.find( ':' );
+                                         int  thread    = std::stoi( record.text.substr( 0, separator ) );
+                                         int  message   = std::stoi( record.text.substr( separator + 1 ) );
+                                         EXPECT_EQ( nextMessage[thread]++, message );
+                                         return true;
+                                     } );
+    ASSERT_EQ( static_cast<uint64_t>( threadCount * messageCount ), expectedSequence );
+
+    std::filesystem::remove_all( directory );
+}
+
+TEST( TestPerThreadFileSink, filesClosedWithSink )
+{
+    auto directory = std::filesystem::temp_directory_path() / "caffaPerThreadFileSinkClosedTest";
+    std::filesystem::remove_all( directory );
+    auto logFile = ( directory / "capture.log" ).string();
+
+    // The main thread outlives the sink, so its file must not be kept open by the thread
+    {
+        auto sink = std::make_shared<caffa::PerThreadFileSink>( logFile );
+        sink->set_pattern( "%v" );
+        caffa::Logger::registerCustomSink( "test.perthread.closed", sink );
+    }
+    caffa::Logger::log( "test.perthread.closed", caffa::Logger::Level::info, "first" );
+    caffa::Logger::log( "test.perthread.closed", caffa::Logger::Level::info, "second" );
+    spdlog::drop( "test.perthread.closed" );
+
+    std::vector<std::string> texts;
+    caffa::PerThreadFileSink::merge( logFile,
+                                     [&]( const caffa::PerThreadFileSink::Record& record )
+                                     {
+                                         texts.push_back( record.text );
+                                         return true;
+                                     } );
+    ASSERT_EQ( 2u, texts.size() );
+    EXPECT_TRUE( texts[0].starts_with( "first" ) );
+    EXPECT_TRUE( texts[1].starts_with( "second" ) );
+
+    std::filesystem::remove_all( directory );
+}
@@ -0,0 +1,461 @@
+#include "gtest/gtest.h"
+
+#include "cafStringTools.h"
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <random>
+#include <set>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+TEST( TestStringTools, join )
+{
+    const std::vector<std::string> words = { "alpha", "beta", "gamma" };
+
+    EXPECT_EQ( "alpha, beta, gamma", caffa::StringTools::join( words.begin(), words.end(), ", " ) );
+    EXPECT_EQ( "alpha, beta, gamma", caffa::StringTools::join( words, ", " ) );
+    EXPECT_EQ( "alphabetagamma", caffa::StringTools::join( words, "" ) );
+    EXPECT_EQ( "", caffa::StringTools::join( std::vector<std::string>(), "," ) );
+    EXPECT_EQ( "alpha", caffa::StringTools::join( std::list<std::string>{ "alpha" }, "," ) );
+
+    const std::vector<std::string_view> views = { "a", "", "c" };
+    EXPECT_EQ( "a//c", caffa::StringTools::join( views, "/" ) );
+
+    const char* pointers[] = { "x", "y", "z" };
+    EXPECT_EQ( "x-y-z", caffa::StringTools::join( pointers, std::string( "-" ) ) );
+
+    std::deque<caffa::StringTools::FixedString<3>> fixed = { "abc", "def" };
+    EXPECT_EQ( "abc.def", caffa::StringTools::join( fixed, "." ) );
+
+    // The end of a take_while view is a sentinel of another type than its iterator
+    auto beforeGamma = std::views::take_while( words, []( const std::string& word ) { return word != "gamma"; } );
+    EXPECT_EQ( "alpha, beta", caffa::StringTools::join( beforeGamma, ", " ) );
+    std::string prefixed = "greek: ";
+    EXPECT_EQ( "greek: alpha beta", caffa::StringTools::join_to( prefixed, beforeGamma, " " ) );
+}
+
+TEST( TestStringTools, joinSinglePass )
+{
+    std::istringstream stream( "one two three" );
+    EXPECT_EQ( "one+two+three",
+               caffa::StringTools::join( std::istream_iterator<std::string>( stream ),
+                                         std::istream_iterator<std::string>(),
+                                         "+" ) );
+}
+
+TEST( TestStringTools, joinTo )
+{
+    const std::vector<std::string> words = { "alpha", "beta" };
+
+    std::string path = "/root";
+    caffa::StringTools::join_to( path, words, "/" );
+    EXPECT_EQ( "/rootalpha/beta", path );
+
+    std::string unchanged = "keep";
+    caffa::StringTools::join_to( unchanged, std::vector<std::string>(), "/" );
+    EXPECT_EQ( "keep", unchanged );
+
+    std::vector<std::string> many( 5000, "component" );
+    std::string              joined;
+    EXPECT_EQ( 5000u * 9u + 4999u, caffa::StringTools::join_to( joined, many, "/" ).size() );
+}
+
+TEST( TestStringTools, split )
+{
+    using Parts = std::vector<std::string>;
+    EXPECT_EQ( ( Parts{ "a", "", "b", "" } ), caffa::StringTools::split<Parts>( "a,,b,", "," ) );
+    EXPECT_EQ( ( Parts{ "a", "b" } ), caffa::StringTools::split<Parts>( "a,,b,", ",", true ) );
+    EXPECT_EQ( ( Parts{ "a", "b" } ), caffa::StringTools::split<Parts>( "a::b", "::" ) );
+    EXPECT_EQ( ( Parts{ "" } ), caffa::StringTools::split<Parts>( "", "," ) );
+    EXPECT_EQ( Parts(), caffa::StringTools::split<Parts>( "", ",", true ) );
+    EXPECT_EQ( ( Parts{ "abc" } ), caffa::StringTools::split<Parts>( "abc", "" ) );
+}
+
+TEST( TestStringTools, splitView )
+{
+    using Views = std::vector<std::string_view>;
+
+    auto toVector = []( auto&& range ) { return Views( range.begin(), range.end() ); };
+
+    EXPECT_EQ( ( Views{ "a", "", "b", "" } ), toVector( caffa::StringTools::split_view( "a,,b,", "," ) ) );
+    EXPECT_EQ( ( Views{ "a", "", "b", "" } ), toVector( caffa::StringTools::split_view( "a,,b,", ',' ) ) );
+    EXPECT_EQ( ( Views{ "a", "b" } ), toVector( caffa::StringTools::split_view( ",a,,b,", ',', true ) ) );
+    EXPECT_EQ( ( Views{ "key", "value" } ), toVector( caffa::StringTools::split_view( "key := value", " := " ) ) );
+    EXPECT_EQ( ( Views{ "" } ), toVector( caffa::StringTools::split_view( "", ',' ) ) );
+    EXPECT_EQ( Views(), toVector( caffa::StringTools::split_view( ",,,", ',', true ) ) );
+
+    // The parts point into the original text
+    const std::string line  = "first second";
+    auto              parts = caffa::StringTools::split_view( line, ' ' );
+    EXPECT_EQ( line.data() + 6, ( *std::next( parts.begin() ) ).data() );
+
+    static_assert( std::ranges::forward_range<decltype( parts )> );
+    static_assert( std::ranges::view<decltype( parts )> && std::ranges::common_range<decltype( parts )> );
+    static_assert( std::ranges::borrowed_range<decltype( parts )> );
+    EXPECT_EQ( 2, std::ranges::distance( parts ) );
+
+    size_t count = 0u;
+    auto   longParts = std::views::filter( []( std::string_view part ) { return part.size() > 5u; } );
+    for ( auto part : caffa::StringTools::split_view( line, ' ' ) | longParts )
+    {
+        EXPECT_EQ( "second", part );
+        ++count;
+    }
+    EXPECT_EQ( 1u, count );
+}
+
+TEST( TestStringTools, splitInto )
+{
+    std::vector<std::string> fields;
+    caffa::StringTools::split_into( fields, "a long first field that does not fit inline,b,c", ',' );
+    ASSERT_EQ( 3u, fields.size() );
+    const auto* firstBuffer = fields[0].data();
+
+    caffa::StringTools::split_into( fields, "another field which is fairly long too,d", "," );
+    ASSERT_EQ( 2u, fields.size() );
+    EXPECT_EQ( "another field which is fairly long too", fields[0] );
+    EXPECT_EQ( "d", fields[1] );
+    EXPECT_EQ( firstBuffer, fields[0].data() );
+
+    caffa::StringTools::split_into( fields, "x,,y,z", ',', true );
+    EXPECT_EQ( ( std::vector<std::string>{ "x", "y", "z" } ), fields );
+
+    std::list<std::string_view> views = { "stale" };
+    caffa::StringTools::split_into( views, "p|q", std::string( "|" ) );
+    EXPECT_EQ( ( std::list<std::string_view>{ "p", "q" } ), views );
+}
+
+TEST( TestStringTools, findMatchesStandardLibrary )
+{
+    std::mt19937 random( 42 );
+    auto         randomText = [&random]( size_t length, char alphabetSize )
+    {
+        std::string text( length, 'a' );
+        for ( auto& c : text )
+            c = static_cast<char>( 'a' + random() % alphabetSize );
+        return text;
+    };
+
+    for ( auto engine : caffa::StringTools::supportedSearchEngines() )
+    {
+        for ( int i = 0; i < 2000; ++i )
+        {
+            // Small alphabets give many partial matches
+            const char  alphabetSize = static_cast<char>( 2 + i % 4 );
+            std::string haystack     = randomText( random() % 200, alphabetSize );
+            std::string needle       = randomText( 1 + random() % 8, alphabetSize );
+            size_t      pos          = haystack.empty() ? 0u : random() % haystack.size();
+
+            SCOPED_TRACE( haystack + " / " + needle + " @ " + std::to_string( pos ) );
+            EXPECT_EQ( std::string_view( haystack ).find( needle, pos ),
+                       caffa::StringTools::find( engine, haystack, needle, pos ) );
+        }
+    }
+}
+
+TEST( TestStringTools, findAtEdges )
+{
+    const std::string haystack = std::string( 100, 'x' ) + "needle";
+    for ( auto engine : caffa::StringTools::supportedSearchEngines() )
+    {
+        EXPECT_EQ( 100u, caffa::StringTools::find( engine, haystack, "needle" ) );
+        EXPECT_EQ( 99u, caffa::StringTools::find( engine, haystack, "xneedle", 95u ) );
+        EXPECT_EQ( std::string::npos, caffa::StringTools::find( engine, haystack, "needles" ) );
+        EXPECT_EQ( std::string::npos, caffa::StringTools::find( engine, haystack, "needle", 101u ) );
+        EXPECT_EQ( std::string::npos, caffa::StringTools::find( engine, haystack, "needle", 1000u ) );
+        EXPECT_EQ( 0u, caffa::StringTools::find( engine, haystack, "" ) );
+        EXPECT_EQ( std::string::npos, caffa::StringTools::find( engine, "", "x" ) );
+    }
+    EXPECT_EQ( 100u, caffa::StringTools::find( haystack, 'n' ) );
+    EXPECT_EQ( 103u, caffa::StringTools::find( haystack, 'd', 50u ) );
+    EXPECT_EQ( std::string::npos, caffa::StringTools::find( haystack, 'y' ) );
+    EXPECT_EQ( std::string::npos, caffa::StringTools::find( haystack, 'x', 500u ) );
+}
+
+TEST( TestStringTools, replace )
+{
+    EXPECT_EQ( "a-b-c", caffa::StringTools::replace( "a, b, c", ", ", "-" ) );
+    EXPECT_EQ( "xxxx", caffa::StringTools::replace( "aa", "a", "xx" ) );
+    EXPECT_EQ( "", caffa::StringTools::replace( "abab", "ab", "" ) );
+    EXPECT_EQ( "unchanged", caffa::StringTools::replace( "unchanged", "missing", "x" ) );
+    EXPECT_EQ( "empty", caffa::StringTools::replace( "empty", "", "x" ) );
+
+    std::string longText;
+    for ( int i = 0; i < 1000; ++i )
+        longText += "some text {name} ";
+    auto replaced = caffa::StringTools::replace( longText, "{name}", "value" );
+    EXPECT_EQ( std::string::npos, replaced.find( "{name}" ) );
+    EXPECT_EQ( longText.size() - 1000u, replaced.size() );
+}
+
+TEST( TestStringTools, regexCache )
+{
+    auto first  = caffa::StringTools::CompiledRegex::get( "\\s*,\\s*" );
+    auto second = caffa::StringTools::CompiledRegex::get( std::string( "\\s*,\\s*" ) );
+    auto icase  = caffa::StringTools::CompiledRegex::get( "\\s*,\\s*", boost::regex::icase );
+    EXPECT_EQ( first, second );
+    EXPECT_NE( first, icase );
+
+    EXPECT_THROW( caffa::StringTools::CompiledRegex::get( "(unterminated" ), boost::regex_error );
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t>      differences = 0u;
+    for ( int i = 0; i < 4; ++i )
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for ( int j = 0; j < 1000; ++j )
+                {
+                    auto regex = caffa::StringTools::CompiledRegex::get( "[;|]" + std::to_string( j % 10 ) );
+                    if ( regex != caffa::StringTools::CompiledRegex::get( "[;|]" + std::to_string( j % 10 ) ) )
+                        differences++;
+                }
+            } );
+    }
+    for ( auto& thread : threads )
+        thread.join();
+    EXPECT_EQ( 0u, differences );
+}
+
+TEST( TestStringTools, regexPrefilter )
+{
+    EXPECT_TRUE( caffa::StringTools::CompiledRegex( "\\s*,\\s*" ).hasPrefilter() );
+    EXPECT_TRUE( caffa::StringTools::CompiledRegex( "[;|]+" ).hasPrefilter() );
+    EXPECT_TRUE( caffa::StringTools::CompiledRegex( "ab|c\\d" ).hasPrefilter() );
+    EXPECT_TRUE( caffa::StringTools::CompiledRegex( "x?y{2,3}" ).hasPrefilter() );
+    EXPECT_TRUE( caffa::StringTools::CompiledRegex( "foo(bar|baz)" ).hasPrefilter() );
+    EXPECT_FALSE( caffa::StringTools::CompiledRegex( "\\s*" ).hasPrefilter() );
+    EXPECT_FALSE( caffa::StringTools::CompiledRegex( "(a|b)" ).hasPrefilter() );
+    EXPECT_FALSE( caffa::StringTools::CompiledRegex( "^a" ).hasPrefilter() );
+    EXPECT_FALSE( caffa::StringTools::CompiledRegex( "a|" ).hasPrefilter() );
+    EXPECT_FALSE( caffa::StringTools::CompiledRegex( "\\S" ).hasPrefilter() );
+
+    auto [pos, length] = caffa::StringTools::CompiledRegex( "\\s*,\\s*" ).search( "key , value" );
+    EXPECT_EQ( 3u, pos );
+    EXPECT_EQ( 3u, length );
+    EXPECT_EQ( std::string_view::npos, caffa::StringTools::CompiledRegex( "," ).search( "no commas" ).first );
+}
+
+TEST( TestStringTools, splitRegexMatchesTokenIterator )
+{
+    // Compare with a plain token iterator split over inputs full of near misses
+    const std::vector<std::string> patterns = {
+        "\\s*,\\s*", "[;|]+", ",", "ab|c\\d", "x?y{2,3}", "\\.", "a*[bc]+?", "\\s*", "(,)", "foo(bar|baz)" };
+    std::vector<std::string> texts = { "", ",", "a,b,", " , a ,b,, c ", "ab;c1|x;;yyy", "xyyxy",
+                                       "a.b", "abab", "c2 c d", ",leading,trailing,", "no match",
+                                       "foobar,foobaz", "fofoobazfooba foobarr" };
+    std::mt19937 random( 7 );
+    for ( int i = 0; i < 200; ++i )
+    {
+        const std::string_view alphabet = " ,;|abcxy.12";
+        std::string            text( random() % 24, ' ' );
+        for ( auto& c : text )
+            c = alphabet[random() % alphabet.size()];
+        texts.push_back( text );
+    }
+
+    for ( const auto& pattern : patterns )
+    {
+        const boost::regex regex( pattern );
+        for ( const auto& text : texts )
+        {
+            for ( bool skipEmptyParts : { false, true } )
+            {
+                std::vector<std::string>     expected;
+                boost::sregex_token_iterator it( text.begin(), text.end(), regex, -1 ), end;
+                for ( ; it != end; ++it )
+                {
+                    if ( !skipEmptyParts || it->length() > 0 ) expected.push_back( *it );
+                }
+
+                SCOPED_TRACE( "'" + pattern + "' on '" + text + "'" );
+                using Parts = std::vector<std::string>;
+                EXPECT_EQ( expected, caffa::StringTools::splitRegex<Parts>( text, pattern, skipEmptyParts ) );
+                EXPECT_EQ( expected, caffa::StringTools::split<Parts>( text, regex, skipEmptyParts ) );
+            }
+        }
+    }
+
+    using Parts = std::vector<std::string>;
+    EXPECT_EQ( ( Parts{ "A", "b", "c" } ),
+               caffa::StringTools::splitRegex<Parts>( "AxbXc", "x", false, boost::regex::icase ) );
+}
+
+TEST( TestStringTools, trim )
+{
+    EXPECT_EQ( "text", caffa::StringTools::trim( " \t text \r\n" ) );
+    EXPECT_EQ( "", caffa::StringTools::trim( " \t\n " ) );
+    EXPECT_EQ( "a b", caffa::StringTools::trim( "a b" ) );
+
+    const std::string padded = "  key = value\n";
+    auto              view   = caffa::StringTools::trim_view( padded );
+    EXPECT_EQ( "key = value", view );
+    EXPECT_EQ( padded.data() + 2, view.data() );
+    EXPECT_EQ( "", caffa::StringTools::trim_view( "   " ) );
+    EXPECT_EQ( "", caffa::StringTools::trim_view( "" ) );
+}
+
+TEST( TestStringTools, caseFolding )
+{
+    // Long enough for both the vectorised blocks and the remainder, with bytes outside ASCII left alone
+    const std::string mixed = "Hello, World! [@`{] ÆØÅ æøå 0123456789 The Quick Brown Fox Jumps";
+    std::string       lower = mixed;
+    std::string       upper = mixed;
+    caffa::StringTools::tolower_in_place( lower );
+    caffa::StringTools::toupper_in_place( upper );
+    EXPECT_EQ( "hello, world! [@`{] ÆØÅ æøå 0123456789 the quick brown fox jumps", lower );
+    EXPECT_EQ( "HELLO, WORLD! [@`{] ÆØÅ æøå 0123456789 THE QUICK BROWN FOX JUMPS", upper );
+    EXPECT_EQ( lower, caffa::StringTools::tolower( mixed ) );
+    EXPECT_EQ( upper, caffa::StringTools::toupper( mixed ) );
+
+    for ( int c = 0; c < 256; ++c )
+    {
+        std::string single( 1, static_cast<char>( c ) );
+        caffa::StringTools::tolower_in_place( single );
+        EXPECT_EQ( c < 128 ? std::tolower( c ) : c, static_cast<unsigned char>( single[0] ) );
+    }
+}
+
+TEST( TestStringTools, caseInsensitiveComparison )
+{
+    EXPECT_TRUE( caffa::StringTools::iequals( "Content-Length", "content-LENGTH" ) );
+    EXPECT_TRUE( caffa::StringTools::iequals( "", "" ) );
+    EXPECT_FALSE( caffa::StringTools::iequals( "Content-Length", "Content-Lengths" ) );
+    EXPECT_FALSE( caffa::StringTools::iequals( "[", "{" ) );
+    EXPECT_FALSE( caffa::StringTools::iequals( "@", "`" ) );
+
+    EXPECT_EQ( std::weak_ordering::equivalent, caffa::StringTools::icompare( "ABCdefGHIjkl", "abcDEFghiJKL" ) );
+    EXPECT_EQ( std::weak_ordering::less, caffa::StringTools::icompare( "abcdefghij_a", "ABCDEFGHIJ_B" ) );
+    EXPECT_EQ( std::weak_ordering::greater, caffa::StringTools::icompare( "B", "a" ) );
+    EXPECT_EQ( std::weak_ordering::less, caffa::StringTools::icompare( "abc", "ABCD" ) );
+    // Ordered like the lower case versions, where '_' comes before 'a'
+    EXPECT_EQ( std::weak_ordering::less, caffa::StringTools::icompare( "_", "A" ) );
+
+    EXPECT_EQ( caffa::StringTools::ihash( "Some-Longer-Header-Name" ),
+               caffa::StringTools::ihash( "some-longer-header-NAME" ) );
+    EXPECT_NE( caffa::StringTools::ihash( "abc" ), caffa::StringTools::ihash( "abd" ) );
+    EXPECT_NE( caffa::StringTools::ihash( "" ), caffa::StringTools::ihash( std::string_view( "\0", 1u ) ) );
+
+    using Hash  = caffa::StringTools::CaseInsensitiveHash;
+    using Equal = caffa::StringTools::CaseInsensitiveEqual;
+
+    std::unordered_map<std::string, int, Hash, Equal> headers = { { "Content-Type", 1 }, { "Accept", 2 } };
+    EXPECT_EQ( 1, headers.find( std::string_view( "content-type" ) )->second );
+    EXPECT_EQ( headers.end(), headers.find( std::string_view( "content" ) ) );
+
+    std::set<std::string, caffa::StringTools::CaseInsensitiveLess> ordered = { "b", "A", "c", "B" };
+    EXPECT_EQ( ( std::vector<std::string>{ "A", "b", "c" } ),
+               std::vector<std::string>( ordered.begin(), ordered.end() ) );
+}
+
+TEST( TestStringTools, caseInsensitiveFind )
+{
+    EXPECT_EQ( 4u, caffa::StringTools::ifind( "the QUICK brown fox", "quick" ) );
+    EXPECT_EQ( 16u, caffa::StringTools::ifind( "the QUICK brown fox", "FOX" ) );
+    EXPECT_EQ( std::string::npos, caffa::StringTools::ifind( "the QUICK brown fox", "fox", 17u ) );
+    EXPECT_EQ( 3u, caffa::StringTools::ifind( "abc", "", 3u ) );
+    EXPECT_EQ( std::string::npos, caffa::StringTools::ifind( "abc", "", 4u ) );
+
+    std::mt19937 random( 3 );
+    for ( int i = 0; i < 2000; ++i )
+    {
+        const std::string_view alphabet = "aAbB[{";
+        std::string            haystack( random() % 100, ' ' );
+        std::string            needle( 1 + random() % 5, ' ' );
+        for ( auto& c : haystack )
+            c = alphabet[random() % alphabet.size()];
+        for ( auto& c : needle )
+            c = alphabet[random() % alphabet.size()];
+
+        SCOPED_TRACE( haystack + " / " + needle );
+        EXPECT_EQ( caffa::StringTools::tolower( haystack ).find( caffa::StringTools::tolower( needle ) ),
+                   caffa::StringTools::ifind( haystack, needle ) );
+    }
+}
+
+TEST( TestStringTools, replaceMany )
+{
+    caffa::StringTools::MultiReplace placeholders( { { "{name}", "Caffa" }, { "{version}", "1.0" }, { "{", "<" } } );
+    EXPECT_EQ( "Caffa 1.0 <unknown}", placeholders.apply( "{name} {version} {unknown}" ) );
+    EXPECT_EQ( "no placeholders", placeholders.apply( "no placeholders" ) );
+    EXPECT_EQ( "", placeholders.apply( "" ) );
+
+    std::string out = "> ";
+    placeholders.apply_to( out, "{name}" );
+    EXPECT_EQ( "> Caffa", out );
+
+    // Leftmost wins, then longest, and replacements are not searched again
+    EXPECT_EQ( "X-d", caffa::StringTools::replace_many( "abc-d", { { "abc", "X" }, { "bc", "Y" }, { "c-d", "Z" } } ) );
+    EXPECT_EQ( "Long", caffa::StringTools::replace_many( "abcd", { { "bc", "Short" }, { "abcd", "Long" } } ) );
+    EXPECT_EQ( "aShorte", caffa::StringTools::replace_many( "abce", { { "bc", "Short" }, { "abcd", "Long" } } ) );
+    EXPECT_EQ( "XYq", caffa::StringTools::replace_many( "abq", { { "a", "X" }, { "b", "Y" }, { "abz", "Z" } } ) );
+    EXPECT_EQ( "bbbb", caffa::StringTools::replace_many( "aa", { { "a", "bb" }, { "b", "c" } } ) );
+    EXPECT_EQ( "2", caffa::StringTools::replace_many( "x", { { "x", "1" }, { "x", "2" } } ) );
+
+    EXPECT_THROW( caffa::StringTools::replace_many( "text", { { "", "x" } } ), std::invalid_argument );
+}
+
+TEST( TestStringTools, replaceManyMatchesNaiveReplacement )
+{
+    // Leftmost-longest replacement done the slow way: try every pattern at every position
+    auto naive = []( const std::string& text, const caffa::StringTools::MultiReplace::Replacements& replacements )
+    {
+        std::string out;
+        for ( size_t i = 0u; i < text.size(); )
+        {
+            const std::pair<std::string, std::string>* best = nullptr;
+            for ( const auto& replacement : replacements )
+            {
+                if ( text.compare( i, replacement.first.size(), replacement.first ) == 0 &&
+                     ( !best || replacement.first.size() > best->first.size() ) )
+                {
+                    best = &replacement;
+                }
+            }
+            if ( best )
+            {
+                out += best->second;
+                i += best->first.size();
+            }
+            else
+            {
+                out += text[i++];
+            }
+        }
+        return out;
+    };
+
+    std::mt19937 random( 11 );
+    auto         randomText = [&random]( size_t length )
+    {
+        std::string text( length, 'a' );
+        for ( auto& c : text )
+            c = static_cast<char>( 'a' + random() % 3 );
+        return text;
+    };
+
+    for ( int i = 0; i < 500; ++i )
+    {
+        caffa::StringTools::MultiReplace::Replacements replacements;
+        std::set<std::string>                          patterns;
+        for ( size_t count = 1u + random() % 5; patterns.size() < count; )
+        {
+            if ( auto pattern = randomText( 1u + random() % 4 ); patterns.insert( pattern ).second )
+            {
+                replacements.emplace_back( pattern, std::to_string( replacements.size() ) );
+            }
+        }
+        const std::string text = randomText( random() % 40 );
+
+        SCOPED_TRACE( text );
+        EXPECT_EQ( naive( text, replacements ), caffa::StringTools::replace_many( text, replacements ) );
+    }
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "cafTimerService.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+template <typename Predicate>
+bool waitFor( Predicate predicate, std::chrono::milliseconds timeout = 5000ms )
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while ( !predicate() )
+    {
+        if ( std::chrono::steady_clock::now() > deadline ) return false;
+        std::this_thread::sleep_for( 1ms );
+    }
+    return true;
+}
+} // namespace
+
+TEST( TestTimerService, runsTimersInOrderOfExpiry )
+{
+    std::mutex       mutex;
+    std::vector<int> order;
+    auto             record = [&]( int value )
+    {
+        std::scoped_lock lock( mutex );
+        order.push_back( value );
+    };
+
+    // Spread over the first two levels of the wheel
+    caffa::TimerService::schedule( 150ms, [&]() { record( 150 ); } );
+    caffa::TimerService::schedule( 10ms, [&]() { record( 10 ); } );
+    caffa::TimerService::schedule( 70ms, [&]() { record( 70 ); } );
+    caffa::TimerService::schedule( 0ms, [&]() { record( 0 ); } );
+
+    ASSERT_TRUE( waitFor(
+        [&]()
+        {
+            std::scoped_lock lock( mutex );
+            return order.size() == 4u;
+        } ) );
+    EXPECT_EQ( std::vector<int>( { 0, 10, 70, 150 } ), order );
+}
+
+TEST( TestTimerService, repeatingTimersRunUntilCancelled )
+{
+    std::atomic<int> runs  = 0;
+    auto             timer = caffa::TimerService::scheduleRepeating( 5ms, [&runs]() { runs++; } );
+
+    ASSERT_TRUE( waitFor( [&runs]() { return runs >= 3; } ) );
+    EXPECT_TRUE( caffa::TimerService::cancel( timer ) );
+
+    int runsAtCancel = runs;
+    std::this_thread::sleep_for( 30ms );
+    EXPECT_EQ( runsAtCancel, runs );
+    EXPECT_FALSE( caffa::TimerService::cancel( timer ) );
+}
+
+TEST( TestTimerService, cancelledAndRescheduledTimers )
+{
+    std::atomic<bool> cancelledRan = false;
+    auto cancelled = caffa::TimerService::schedule( 20ms, [&cancelledRan]() { cancelledRan = true; } );
+    EXPECT_TRUE( caffa::TimerService::cancel( cancelled ) );
+
+    // Far enough out to sit on the top level of the wheel
+    std::atomic<bool> rescheduledRan = false;
+    auto rescheduled = caffa::TimerService::schedule( 10h, [&rescheduledRan]() { rescheduledRan = true; } );
+    EXPECT_TRUE( caffa::TimerService::reschedule( rescheduled, 10ms ) );
+
+    ASSERT_TRUE( waitFor( [&rescheduledRan]() { return rescheduledRan.load(); } ) );
+    std::this_thread::sleep_for( 30ms );
+    EXPECT_FALSE( cancelledRan );
+    EXPECT_FALSE( caffa::TimerService::reschedule( rescheduled, 10ms ) );
+}
+
+TEST( TestTimerService, cancelWaitsForRunningTask )
+{
+    std::atomic<bool> started  = false;
+    std::atomic<bool> finished = false;
+    auto              task     = [&]()
+    {
+        started = true;
+        std::this_thread::sleep_for( 50ms );
+        finished = true;
+    };
+    auto timer = caffa::TimerService::schedule( 0ms, task );
+
+    ASSERT_TRUE( waitFor( [&started]() { return started.load(); } ) );
+    caffa::TimerService::cancel( timer );
+    EXPECT_TRUE( finished );
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "cafStringTools.h"
+#include "cafTracing.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+void tracedWork( int value )
+{
+    CAFFA_TRACE_SCOPE_ARG( "tracedWork", "value", value );
+    {
+        CAFFA_TRACE_SCOPE( "inner \"quoted\"" );
+    }
+}
+
+std::string readFile( const std::filesystem::path& path )
+{
+    std::ifstream     stream( path );
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    return contents.str();
+}
+
+size_t countOf( const std::string& text, const std::string& what )
+{
+    return caffa::StringTools::split( text, what ).size() - 1u;
+}
+} // namespace
+
+TEST( TestTracing, exportChromeTrace )
+{
+    auto traceFile = std::filesystem::temp_directory_path() / "caffaTracingTest.json";
+
+    tracedWork( 0 ); // Not recorded since tracing is off
+    ASSERT_FALSE( caffa::Tracing::enabled() );
+
+    ASSERT_TRUE( caffa::Tracing::start( traceFile.string(), std::chrono::milliseconds( 1 ) ) );
+    std::thread worker(
+        []()
+        {
+            for ( int i = 0; i < 10; ++i )
+                tracedWork( i );
+        } );
+    for ( int i = 0; i < 10; ++i )
+    {
+        tracedWork( i );
+    }
+    worker.join();
+    caffa::Tracing::stop();
+    tracedWork( 0 );
+
+    auto trace = readFile( traceFile );
+    ASSERT_EQ( 0u, trace.find( "{\"traceEvents\":[" ) );
+    ASSERT_EQ( trace.size() - 3u, trace.rfind( "]}\n" ) );
+    ASSERT_EQ( 40u, countOf( trace, "\"ph\":\"X\"" ) );
+    ASSERT_EQ( 20u, countOf( trace, "\"name\":\"inner \\\"quoted\\\"\"" ) );
+    ASSERT_EQ( 2u, countOf( trace, "\"args\":{\"value\":9}" ) );
+    ASSERT_EQ( 0u, caffa::Tracing::droppedSpans() );
+
+    std::filesystem::remove( traceFile );
+}
+
+TEST( TestTracing, notEnabledWhenFileCannotBeOpened )
+{
+    auto traceFile = std::filesystem::temp_directory_path() / "caffaTracingMissingDirectory" / "trace.json";
+    std::filesystem::remove_all( traceFile.parent_path() );
+
+    ASSERT_FALSE( caffa::Tracing::start( traceFile.string() ) );
+    EXPECT_FALSE( caffa::Tracing::enabled() );
+    caffa::Tracing::stop();
+}
+
+TEST( TestTracing, skipsSpansEndingBeforeStart )
+{
+    auto traceFile = std::filesystem::temp_directory_path() / "caffaTracingStaleTest.json";
+
+    // A worker that exits outside a session leaves nothing behind
+    std::thread( []() { caffa::Tracing::record( { "beforeSession", 1u, 2u, nullptr, 0 } ); } ).join();
+
+    ASSERT_TRUE( caffa::Tracing::start( traceFile.string(), std::chrono::milliseconds( 1 ) ) );
+    caffa::Tracing::record( { "stale", 1u, 2u, nullptr, 0 } );
+    tracedWork( 1 );
+    caffa::Tracing::stop();
+
+    auto trace = readFile( traceFile );
+    ASSERT_EQ( trace.size() - 3u, trace.rfind( "]}\n" ) );
+    EXPECT_EQ( 2u, countOf( trace, "\"ph\":\"X\"" ) );
+    EXPECT_EQ( 0u, countOf( trace, "stale" ) );
+    EXPECT_EQ( 0u, countOf( trace, "beforeSession" ) );
+
+    std::filesystem::remove( traceFile );
+}
@@ -0,0 +1,69 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafPerThreadFileSink.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+void printUsage( const char* program )
+{
+    std::cerr << "Usage: " << program << " <log file> [--sequence]" << std::endl
+              << "Merges the per thread files (name.thread<id>.ext) of a log file in the order the records were "
+                 "logged"
+              << std::endl
+              << std::endl
+              << "Options:" << std::endl
+              << "  --sequence  Prefix each record with its sequence number and time stamp in nanoseconds"
+              << std::endl;
+}
+} // namespace
+
+int main( int argc, char** argv )
+{
+    bool withSequence = argc == 3 && std::string( argv[2] ) == "--sequence";
+    if ( argc < 2 || ( argc == 3 && !withSequence ) || argc > 3 )
+    {
+        printUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    if ( caffa::PerThreadFileSink::threadFiles( argv[1] ).empty() )
+    {
+        std::cerr << "No per thread log files found for " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    caffa::PerThreadFileSink::merge( argv[1],
+                                     [withSequence]( const caffa::PerThreadFileSink::Record& record )
+                                     {
+                                         if ( withSequence )
+                                         {
+                                             std::cout << record.sequence << ' ' << record.timestamp << ' ';
+                                         }
+                                         std::cout << record.text;
+                                         return true;
+                                     } );
+    return EXIT_SUCCESS;
+}
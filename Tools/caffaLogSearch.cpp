@@ -0,0 +1,105 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafLogSearch.h"
+#include "cafLogger.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+void printUsage( const char* program )
+{
+    std::cerr << "Usage: " << program << " <log file> [options]" << std::endl
+              << "Searches the log file and its rotated siblings (name.1.ext, name.2.ext, ...)" << std::endl
+              << std::endl
+              << "Options:" << std::endl
+              << "  --from \"YYYY-mm-dd HH:MM:SS[.mmm]\"  Only records at or after this time" << std::endl
+              << "  --to \"YYYY-mm-dd HH:MM:SS[.mmm]\"    Only records at or before this time" << std::endl
+              << "  --level <level>                     Only records of this level or more severe" << std::endl
+              << "  --text <text>                       Only records containing the text" << std::endl
+              << "  --max <count>                       Stop after this many records" << std::endl;
+}
+} // namespace
+
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        printUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    caffa::LogSearch::Query query;
+    for ( int i = 2; i < argc; ++i )
+    {
+        std::string option = argv[i];
+        if ( i + 1 >= argc )
+        {
+            printUsage( argv[0] );
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if ( option == "--from" || option == "--to" )
+        {
+            auto timestamp = caffa::LogSearch::parseTimestamp( value );
+            if ( !timestamp )
+            {
+                std::cerr << "Invalid time: " << value << std::endl;
+                return EXIT_FAILURE;
+            }
+            ( option == "--from" ? query.from : query.to ) = timestamp;
+        }
+        else if ( option == "--level" )
+        {
+            query.minimumLevel = caffa::Logger::logLevelFromLabel( value );
+        }
+        else if ( option == "--text" )
+        {
+            query.text = value;
+        }
+        else if ( option == "--max" )
+        {
+            query.maxResults = std::stoul( value );
+        }
+        else
+        {
+            printUsage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    }
+
+    caffa::LogSearch search( argv[1] );
+    if ( search.files().empty() )
+    {
+        std::cerr << "No log files found for " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for ( const auto& match : search.search( query ) )
+    {
+        std::cout << match.record << '\n';
+    }
+    return EXIT_SUCCESS;
+}
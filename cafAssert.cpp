@@ -1,11 +1,13 @@
 #include "cafAssert.h"
 
 #include "cafLogger.h"
+#include "cafProbes.h"
 
 #include <cstdlib>
 
-void caffa::_caffa_assert( const std::string& errorMessage )
+void caffa::_caffa_assert( const char* message ) noexcept
 {
-    CAFFA_CRITICAL( errorMessage );
+    CAFFA_PROBE( assert_failed, message );
+    CAFFA_CRITICAL( message );
     std::abort();
 }
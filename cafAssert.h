@@ -1,20 +1,59 @@
-
 #pragma once
 
-#include <sstream>
+#include "cafNotNull.h"
+
+//
+// Assertion tiers, chosen with CAFFA_ASSERT_LEVEL:
+//   CAFFA_ASSERT_LEVEL_ASSUME  (0): CAFFA_ASSERT only tells the optimiser the condition holds, see CAFFA_ASSUME.
+//                                   A false condition is undefined behaviour. CAFFA_ASSERT_AUDIT is not evaluated.
+//   CAFFA_ASSERT_LEVEL_DEFAULT (1): CAFFA_ASSERT is checked, CAFFA_ASSERT_AUDIT is not evaluated.
+//   CAFFA_ASSERT_LEVEL_AUDIT   (2): Both are checked.
+//
+// Asserted conditions should be free of side effects, as whether they are evaluated depends on the level.
+// Use CAFFA_ASSERT_AUDIT for checks that are too expensive for production, such as walking a container.
+//
+#define CAFFA_ASSERT_LEVEL_ASSUME 0
+#define CAFFA_ASSERT_LEVEL_DEFAULT 1
+#define CAFFA_ASSERT_LEVEL_AUDIT 2
+
+#ifndef CAFFA_ASSERT_LEVEL
+#define CAFFA_ASSERT_LEVEL CAFFA_ASSERT_LEVEL_DEFAULT
+#endif
+
+#if defined( __clang__ ) || defined( __GNUC__ )
+#define CAFFA_COLD_NOINLINE [[gnu::cold, gnu::noinline]]
+#elif defined( _MSC_VER )
+#define CAFFA_COLD_NOINLINE __declspec( noinline )
+#else
+#define CAFFA_COLD_NOINLINE
+#endif
 
 namespace caffa
 {
-void _caffa_assert( const std::string& errorMessage );
-}
-
-#define CAFFA_ASSERT( expr )                                                                \
-    do                                                                                      \
-    {                                                                                       \
-        if ( !( expr ) )                                                                    \
-        {                                                                                   \
-            std::stringstream str;                                                          \
-            str << __FILE__ << ":" << __LINE__ << ": CAFFA_ASSERT(" << #expr << ") failed"; \
-            caffa::_caffa_assert( str.str() );                                              \
-        }                                                                                   \
-    } while ( false )
+/**
+ * Report a failed assertion and abort. Kept out of line and cold so a check only costs a compare and a branch at
+ * the call site, with the message a single string literal.
+ */
+[[noreturn]] CAFFA_COLD_NOINLINE void _caffa_assert( const char* message ) noexcept;
+} // namespace caffa
+
+// The description is stringified by the public macros, before the expression gets macro expanded
+#define CAFFA_ASSERT_CHECK( DESCRIPTION, expr ) \
+    ( CAFFA_LIKELY( expr )                      \
+          ? static_cast<void>( 0 )              \
+          : caffa::_caffa_assert( __FILE__ ":" CAFFA_STRINGIFY( __LINE__ ) ": " DESCRIPTION " failed" ) )
+
+// Keeps the names in the expression used without evaluating it
+#define CAFFA_ASSERT_UNEVALUATED( expr ) static_cast<void>( sizeof( !( expr ) ) )
+
+#if CAFFA_ASSERT_LEVEL >= CAFFA_ASSERT_LEVEL_DEFAULT
+#define CAFFA_ASSERT( expr ) CAFFA_ASSERT_CHECK( "CAFFA_ASSERT(" #expr ")", expr )
+#else
+#define CAFFA_ASSERT( expr ) CAFFA_ASSUME( expr )
+#endif
+
+#if CAFFA_ASSERT_LEVEL >= CAFFA_ASSERT_LEVEL_AUDIT
+#define CAFFA_ASSERT_AUDIT( expr ) CAFFA_ASSERT_CHECK( "CAFFA_ASSERT_AUDIT(" #expr ")", expr )
+#else
+#define CAFFA_ASSERT_AUDIT( expr ) CAFFA_ASSERT_UNEVALUATED( expr )
+#endif
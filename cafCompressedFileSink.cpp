@@ -0,0 +1,351 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafCompressedFileSink.h"
+
+#include "cafLogger.h"
+#include "cafProbes.h"
+
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include <zstd.h>
+
+#include <filesystem>
+
+using namespace caffa;
+
+namespace
+{
+// Frames waiting for compression before the logging threads have to wait for the worker
+constexpr size_t MaxPendingFrames = 4u;
+
+int64_t toMilliseconds( spdlog::log_clock::time_point time )
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>( time.time_since_epoch() ).count();
+}
+} // namespace
+
+CompressedRotatingFileSink::CompressedRotatingFileSink( const std::string&        logFile,
+                                                        size_t                    maxFileSize,
+                                                        size_t                    maxRotatedFiles,
+                                                        size_t                    frameSize,
+                                                        std::chrono::milliseconds flushInterval,
+                                                        int                       compressionLevel )
+    : m_logFile( logFile )
+    , m_maxFileSize( maxFileSize )
+    , m_maxRotatedFiles( maxRotatedFiles )
+    , m_frameSize( std::max( frameSize, size_t( 1u ) ) )
+    , m_flushInterval( flushInterval )
+    , m_compressionLevel( compressionLevel )
+{
+    std::error_code error;
+    if ( std::filesystem::file_size( m_logFile, error ) > 0u && !error )
+    {
+        rotate();
+    }
+    else
+    {
+        openFiles();
+    }
+    m_frame.records.reserve( m_frameSize );
+    m_worker = std::thread( &CompressedRotatingFileSink::compressFrames, this );
+}
+
+CompressedRotatingFileSink::~CompressedRotatingFileSink()
+{
+    {
+        std::scoped_lock lock( mutex_ );
+        closeFrame();
+    }
+    {
+        std::scoped_lock lock( m_queueMutex );
+        m_stopping = true;
+    }
+    m_queueChanged.notify_all();
+    m_worker.join();
+    closeFiles();
+}
+
+std::string CompressedRotatingFileSink::indexFileName( const std::string& logFile )
+{
+    return logFile + ".idx";
+}
+
+std::vector<CompressedRotatingFileSink::FrameIndexEntry>
+    CompressedRotatingFileSink::readFrameIndex( const std::string& logFile )
+{
+    std::vector<FrameIndexEntry> entries;
+
+    std::FILE* indexFile = std::fopen( indexFileName( logFile ).c_str(), "rb" );
+    if ( !indexFile ) return entries;
+
+    FrameIndexEntry entry;
+    while ( std::fread( &entry, sizeof( entry ), 1u, indexFile ) == 1u )
+    {
+        entries.push_back( entry );
+    }
+    std::fclose( indexFile );
+    return entries;
+}
+
+std::string CompressedRotatingFileSink::decompress( const std::string&                    logFile,
+                                                    std::chrono::system_clock::time_point from )
+{
+    auto fromTimestamp = toMilliseconds( from );
+
+    std::FILE* file = std::fopen( logFile.c_str(), "rb" );
+    if ( !file )
+    {
+        spdlog::throw_spdlog_ex( "Could not open " + logFile, errno );
+    }
+
+    std::string       records;
+    std::vector<char> compressed;
+    for ( const auto& entry : readFrameIndex( logFile ) )
+    {
+        if ( entry.lastTimestamp < fromTimestamp ) continue;
+
+        compressed.resize( entry.compressedSize );
+        if ( std::fseek( file, static_cast<long>( entry.compressedOffset ), SEEK_SET ) != 0 ||
+             std::fread( compressed.data(), 1u, compressed.size(), file ) != compressed.size() )
+        {
+            break;
+        }
+
+        auto offset = records.size();
+        records.resize( offset + entry.uncompressedSize );
+        auto size =
+            ZSTD_decompress( records.data() + offset, entry.uncompressedSize, compressed.data(), compressed.size() );
+        if ( ZSTD_isError( size ) )
+        {
+            std::fclose( file );
+            spdlog::throw_spdlog_ex( "Could not decompress frame of " + logFile + ": " + ZSTD_getErrorName( size ) );
+        }
+        records.resize( offset + size );
+    }
+    std::fclose( file );
+    return records;
+}
+
+void CompressedRotatingFileSink::sink_it_( const spdlog::details::log_msg& msg )
+{
+    m_formatted.clear();
+    formatter_->format( msg, m_formatted );
+
+    auto now = std::chrono::steady_clock::now();
+    if ( m_frame.records.empty() )
+    {
+        m_frameStarted         = now;
+        m_frame.firstTimestamp = toMilliseconds( msg.time );
+    }
+    m_frame.records.append( m_formatted.data(), m_formatted.size() );
+    m_frame.recordCount++;
+    m_frame.lastTimestamp = toMilliseconds( msg.time );
+
+    if ( m_frame.records.size() >= m_frameSize || now - m_frameStarted >= m_flushInterval )
+    {
+        closeFrame();
+    }
+}
+
+void CompressedRotatingFileSink::flush_()
+{
+    // The records of a flush, often the error that triggered it, must not be left in memory
+    closeFrame();
+
+    std::unique_lock lock( m_queueMutex );
+    auto             flush = ++m_flushesRequested;
+    m_queueChanged.notify_all();
+    m_queueChanged.wait( lock, [this, flush]() { return m_flushesDone >= flush; } );
+}
+
+size_t CompressedRotatingFileSink::droppedCount() const
+{
+    return m_dropped.load( std::memory_order_relaxed );
+}
+
+void CompressedRotatingFileSink::closeFrame()
+{
+    if ( m_frame.records.empty() ) return;
+
+    {
+        std::unique_lock lock( m_queueMutex );
+        m_queueChanged.wait( lock, [this]() { return m_pendingFrames.size() < MaxPendingFrames; } );
+        m_pendingFrames.push_back( std::move( m_frame ) );
+
+        // Reuse the buffer of a frame the worker is done with
+        m_frame = Frame();
+        if ( !m_freeFrames.empty() )
+        {
+            m_frame = std::move( m_freeFrames.back() );
+            m_freeFrames.pop_back();
+        }
+    }
+    m_queueChanged.notify_all();
+
+    m_frame.records.clear();
+    m_frame.records.reserve( m_frameSize );
+    m_frame.recordCount = 0u;
+}
+
+void CompressedRotatingFileSink::compressFrames()
+{
+    Logger::workerThreadConfiguration( Logger::WorkerThread::compression ).applyToCurrentThread();
+
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter( context, ZSTD_c_compressionLevel, m_compressionLevel );
+
+    Frame             frame;
+    std::vector<char> compressed;
+    while ( true )
+    {
+        {
+            std::unique_lock lock( m_queueMutex );
+            m_queueChanged.wait( lock,
+                                 [this]()
+                                 {
+                                     return !m_pendingFrames.empty() || m_flushesDone < m_flushesRequested ||
+                                            m_stopping;
+                                 } );
+            if ( m_pendingFrames.empty() && m_flushesDone < m_flushesRequested )
+            {
+                // All frames closed before the flush requests have been written by now
+                auto flushes = m_flushesRequested;
+                lock.unlock();
+                CAFFA_PROBE( flush );
+                if ( m_file ) std::fflush( m_file );
+                if ( m_indexFile ) std::fflush( m_indexFile );
+                lock.lock();
+                m_flushesDone = flushes;
+                lock.unlock();
+                m_queueChanged.notify_all();
+                continue;
+            }
+            if ( m_pendingFrames.empty() ) break; // Stopping with everything written
+            frame = std::move( m_pendingFrames.front() );
+            m_pendingFrames.pop_front();
+        }
+        m_queueChanged.notify_all();
+
+        compressed.resize( ZSTD_compressBound( frame.records.size() ) );
+        auto size =
+            ZSTD_compress2( context, compressed.data(), compressed.size(), frame.records.data(), frame.records.size() );
+        if ( ZSTD_isError( size ) )
+        {
+            dropFrame( frame, ZSTD_getErrorName( size ) );
+        }
+        else
+        {
+            compressed.resize( size );
+            try
+            {
+                writeFrame( frame, compressed );
+            }
+            catch ( const std::exception& e )
+            {
+                dropFrame( frame, e.what() );
+            }
+        }
+
+        std::scoped_lock lock( m_queueMutex );
+        m_freeFrames.push_back( std::move( frame ) );
+    }
+    ZSTD_freeCCtx( context );
+}
+
+void CompressedRotatingFileSink::writeFrame( const Frame& frame, const std::vector<char>& compressed )
+{
+    // Files that could not be opened before are tried again by rotating, which keeps what was written to them
+    if ( !m_file || !m_indexFile || ( m_compressedSize > 0u && m_compressedSize + compressed.size() > m_maxFileSize ) )
+    {
+        rotate();
+    }
+
+    std::fwrite( compressed.data(), 1u, compressed.size(), m_file );
+    // The frame has to be in the file before the index refers to it
+    std::fflush( m_file );
+
+    FrameIndexEntry entry{ m_compressedSize,
+                           compressed.size(),
+                           m_uncompressedOffset,
+                           frame.records.size(),
+                           frame.firstTimestamp,
+                           frame.lastTimestamp };
+    std::fwrite( &entry, sizeof( entry ), 1u, m_indexFile );
+    std::fflush( m_indexFile );
+
+    m_compressedSize += compressed.size();
+    m_uncompressedOffset += frame.records.size();
+}
+
+void CompressedRotatingFileSink::dropFrame( const Frame& frame, const char* error )
+{
+    m_dropped.fetch_add( frame.recordCount, std::memory_order_relaxed );
+    CAFFA_PROBE( message_drop, -1, frame.recordCount );
+    std::fprintf( stderr, "[*** LOG ERROR in CompressedRotatingFileSink ***] %s\n", error );
+}
+
+void CompressedRotatingFileSink::openFiles()
+{
+    auto directory = std::filesystem::path( m_logFile ).parent_path();
+    if ( !directory.empty() )
+    {
+        std::filesystem::create_directories( directory );
+    }
+
+    m_file      = std::fopen( m_logFile.c_str(), "wb" );
+    m_indexFile = std::fopen( indexFileName( m_logFile ).c_str(), "wb" );
+    if ( !m_file || !m_indexFile )
+    {
+        closeFiles();
+        spdlog::throw_spdlog_ex( "Could not open compressed log file " + m_logFile, errno );
+    }
+    m_compressedSize     = 0u;
+    m_uncompressedOffset = 0u;
+}
+
+void CompressedRotatingFileSink::closeFiles()
+{
+    if ( m_file ) std::fclose( m_file );
+    if ( m_indexFile ) std::fclose( m_indexFile );
+    m_file      = nullptr;
+    m_indexFile = nullptr;
+}
+
+void CompressedRotatingFileSink::rotate()
+{
+    CAFFA_PROBE( rotate_start, m_logFile.c_str() );
+    closeFiles();
+    for ( size_t i = m_maxRotatedFiles; i > 0u; --i )
+    {
+        auto source      = spdlog::sinks::rotating_file_sink_st::calc_filename( m_logFile, i - 1u );
+        auto destination = spdlog::sinks::rotating_file_sink_st::calc_filename( m_logFile, i );
+        if ( !std::filesystem::exists( source ) ) continue;
+
+        std::filesystem::rename( source, destination );
+        if ( std::filesystem::exists( indexFileName( source ) ) )
+        {
+            std::filesystem::rename( indexFileName( source ), indexFileName( destination ) );
+        }
+    }
+    openFiles();
+    CAFFA_PROBE( rotate_end, m_logFile.c_str() );
+}
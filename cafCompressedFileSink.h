@@ -0,0 +1,147 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "spdlog/sinks/base_sink.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * A rotating file sink writing zstd compressed log files.
+ *
+ * Records are collected into frames that are compressed independently on a worker thread, so each file is a
+ * valid .zst stream and any frame can be decompressed on its own. A frame is closed when it reaches frameSize
+ * uncompressed bytes, when a record arrives more than flushInterval after the frame was started, or when the sink
+ * is flushed. A flush returns once the worker has written out all frames closed before it.
+ * Next to each log file an index file (see indexFileName) lists the frames with their offsets and time range,
+ * so tools can seek to a point in time without decompressing the whole file.
+ *
+ * As with Logger::registerFileLogger the file is rotated on open and whenever it would grow beyond
+ * maxFileSize, here counted in compressed bytes, keeping maxRotatedFiles old files. If the files cannot be opened
+ * the frames are dropped, and opening is tried again with the next frame.
+ */
+class CompressedRotatingFileSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    /**
+     * One entry of the frame index. Timestamps are milliseconds since the epoch.
+     * Stored as native endian 64-bit values.
+     */
+    struct FrameIndexEntry
+    {
+        uint64_t compressedOffset;
+        uint64_t compressedSize;
+        uint64_t uncompressedOffset;
+        uint64_t uncompressedSize;
+        int64_t  firstTimestamp;
+        int64_t  lastTimestamp;
+    };
+
+    CompressedRotatingFileSink( const std::string&        logFile,
+                                size_t                    maxFileSize,
+                                size_t                    maxRotatedFiles,
+                                size_t                    frameSize        = 1024u * 1024u,
+                                std::chrono::milliseconds flushInterval    = std::chrono::milliseconds( 1000 ),
+                                int                       compressionLevel = 3 );
+    ~CompressedRotatingFileSink() override;
+
+    CompressedRotatingFileSink( const CompressedRotatingFileSink& )            = delete;
+    CompressedRotatingFileSink& operator=( const CompressedRotatingFileSink& ) = delete;
+
+    static std::string                  indexFileName( const std::string& logFile );
+    static std::vector<FrameIndexEntry> readFrameIndex( const std::string& logFile );
+
+    /**
+     * Decompress the frames of a log file holding records from the given time on
+     */
+    static std::string decompress( const std::string&                    logFile,
+                                   std::chrono::system_clock::time_point from = {} );
+
+    /**
+     * Number of records that could not be written
+     */
+    size_t droppedCount() const;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& msg ) override;
+    void flush_() override;
+
+private:
+    struct Frame
+    {
+        std::string records;
+        size_t      recordCount    = 0u;
+        int64_t     firstTimestamp = 0;
+        int64_t     lastTimestamp  = 0;
+    };
+
+    void closeFrame();
+    void compressFrames();
+    void writeFrame( const Frame& frame, const std::vector<char>& compressed );
+    void dropFrame( const Frame& frame, const char* error );
+    void openFiles();
+    void closeFiles();
+    void rotate();
+
+    std::string               m_logFile;
+    size_t                    m_maxFileSize;
+    size_t                    m_maxRotatedFiles;
+    size_t                    m_frameSize;
+    std::chrono::milliseconds m_flushInterval;
+    int                       m_compressionLevel;
+
+    // Owned by the logging threads, under the sink mutex
+    spdlog::memory_buf_t                  m_formatted;
+    Frame                                 m_frame;
+    std::chrono::steady_clock::time_point m_frameStarted;
+
+    // Handed between the logging threads and the worker
+    std::mutex              m_queueMutex;
+    std::condition_variable m_queueChanged;
+    std::deque<Frame>       m_pendingFrames;
+    std::vector<Frame>      m_freeFrames;
+    uint64_t                m_flushesRequested = 0u;
+    uint64_t                m_flushesDone      = 0u;
+    bool                    m_stopping         = false;
+    std::atomic<size_t>     m_dropped          = 0u;
+
+    // Owned by the worker
+    std::FILE* m_file               = nullptr;
+    std::FILE* m_indexFile          = nullptr;
+    uint64_t   m_compressedSize     = 0u;
+    uint64_t   m_uncompressedOffset = 0u;
+
+    std::thread m_worker;
+};
+
+} // namespace caffa
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//   Caffa
+//   Copyright (C) Kontur AS
+//
+//   GNU Lesser General Public License Usage
+//   This library is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU Lesser General Public License as published by
+//   the Free Software Foundation; either version 2.1 of the License, or
+//   (at your option) any later version.
+//
+//   This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//   FITNESS FOR A PARTICULAR PURPOSE.
+//
+//   See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//   for more details.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace caffa::StringTools
+{
+/**
+ * A fixed string class that is possible to use as a template parameter
+ */
+template <std::size_t N>
+struct FixedString
+{
+    std::array<char, N + 1> data{};
+
+    constexpr FixedString( const char* string ) noexcept { std::copy_n( string, N + 1, data.data() ); }
+
+    constexpr operator std::string_view() const noexcept { return std::string_view( data.data(), N ); }
+
+    constexpr auto size() const noexcept { return N; }
+};
+
+template <unsigned N>
+FixedString( char const ( & )[N] ) -> FixedString<N - 1>;
+
+} // namespace caffa::StringTools
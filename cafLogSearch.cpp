@@ -0,0 +1,406 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafLogSearch.h"
+
+#include "cafStringTools.h"
+
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <thread>
+
+using namespace caffa;
+
+namespace
+{
+constexpr size_t TimestampLength = 23u; // 2024-01-31 12:34:56.789
+
+struct RecordHeader
+{
+    LogSearch::Timestamp timestamp;
+    Logger::Level        level;
+};
+
+std::optional<int> parseNumber( std::string_view text, size_t pos, size_t digits )
+{
+    int value = 0;
+    for ( size_t i = pos; i < pos + digits; ++i )
+    {
+        if ( text[i] < '0' || text[i] > '9' ) return std::nullopt;
+        value = value * 10 + ( text[i] - '0' );
+    }
+    return value;
+}
+
+std::optional<Logger::Level> parseLevel( std::string_view label )
+{
+    static constexpr std::array<std::pair<std::string_view, Logger::Level>, 9> labels = {
+        { { "trace", Logger::Level::trace },
+          { "debug", Logger::Level::debug },
+          { "info", Logger::Level::info },
+          { "warning", Logger::Level::warn },
+          { "warn", Logger::Level::warn },
+          { "error", Logger::Level::err },
+          { "err", Logger::Level::err },
+          { "critical", Logger::Level::critical },
+          { "off", Logger::Level::off } } };
+
+    for ( auto [text, level] : labels )
+    {
+        if ( text == label ) return level;
+    }
+    return std::nullopt;
+}
+
+/**
+ * Parse the timestamp and level at the start of a record. Returns nothing if the line does not start a record.
+ */
+std::optional<RecordHeader> parseHeader( std::string_view data, size_t pos )
+{
+    if ( data.size() < pos + TimestampLength + 2u || data[pos] != '[' || data[pos + TimestampLength + 1u] != ']' )
+    {
+        return std::nullopt;
+    }
+    auto timestamp = LogSearch::parseTimestamp( data.substr( pos + 1u, TimestampLength ) );
+    if ( !timestamp ) return std::nullopt;
+
+    // The level is one of the following bracketed fields, after the logger name in the default pattern
+    RecordHeader header{ *timestamp, Logger::Level::info };
+    size_t       fieldStart = pos + TimestampLength + 2u;
+    for ( int field = 0; field < 3; ++field )
+    {
+        if ( data.size() < fieldStart + 3u || data[fieldStart] != ' ' || data[fieldStart + 1u] != '[' ) break;
+
+        size_t fieldEnd = data.find_first_of( "]\n", fieldStart + 2u );
+        if ( fieldEnd == std::string_view::npos || data[fieldEnd] != ']' ) break;
+
+        if ( auto level = parseLevel( data.substr( fieldStart + 2u, fieldEnd - fieldStart - 2u ) ); level )
+        {
+            header.level = *level;
+            break;
+        }
+        fieldStart = fieldEnd + 1u;
+    }
+    return header;
+}
+
+/**
+ * Bit of a level in the level mask of an index block
+ */
+constexpr uint8_t levelBit( Logger::Level level ) noexcept
+{
+    return static_cast<uint8_t>( 1u << static_cast<unsigned>( level ) );
+}
+
+/**
+ * Find the first record starting at or after pos
+ */
+size_t nextRecordStart( std::string_view data, size_t pos )
+{
+    if ( ( pos == 0u || data[pos - 1u] == '\n' ) && parseHeader( data, pos ) ) return pos;
+
+    while ( pos < data.size() )
+    {
+        size_t lineBreak = data.find( '\n', pos );
+        if ( lineBreak == std::string_view::npos ) return data.size();
+        pos = lineBreak + 1u;
+        if ( parseHeader( data, pos ) ) return pos;
+    }
+    return data.size();
+}
+
+/**
+ * Find the start of the record containing pos
+ */
+size_t recordStartBefore( std::string_view data, size_t pos )
+{
+    while ( true )
+    {
+        size_t lineBreak = pos == 0u ? std::string_view::npos : data.rfind( '\n', pos - 1u );
+        size_t lineStart = lineBreak == std::string_view::npos ? 0u : lineBreak + 1u;
+        if ( lineStart == 0u || parseHeader( data, lineStart ) ) return lineStart;
+        pos = lineBreak;
+    }
+}
+
+} // namespace
+
+struct LogSearch::MappedFile
+{
+    /**
+     * A block of records from offset up to the offset of the next entry
+     */
+    struct IndexEntry
+    {
+        size_t    offset;
+        Timestamp timestamp;
+        uint8_t   levels; ///< Bit mask of the levels of the records starting in the block
+    };
+
+    MappedFile( const std::string& fileName, size_t indexStride )
+        : name( fileName )
+    {
+        if ( std::filesystem::file_size( fileName ) > 0u )
+        {
+            mapping = boost::interprocess::file_mapping( fileName.c_str(), boost::interprocess::read_only );
+            region  = boost::interprocess::mapped_region( mapping, boost::interprocess::read_only );
+            data    = std::string_view( static_cast<const char*>( region.get_address() ), region.get_size() );
+        }
+
+        for ( size_t pos = 0u; pos < data.size(); pos += indexStride )
+        {
+            size_t start = nextRecordStart( data, pos );
+            if ( start == data.size() ) break;
+            if ( index.empty() || index.back().offset != start )
+            {
+                index.push_back( { start, parseHeader( data, start )->timestamp, 0u } );
+            }
+        }
+
+        for ( size_t i = 0u; i < index.size(); ++i )
+        {
+            size_t blockEnd = i + 1u < index.size() ? index[i + 1u].offset : data.size();
+            for ( size_t start = index[i].offset; start < blockEnd; start = nextRecordStart( data, start + 1u ) )
+            {
+                index[i].levels |= levelBit( parseHeader( data, start )->level );
+            }
+        }
+    }
+
+    /**
+     * The first position at or after pos in a block with a record of one of the levels, or the end of the data
+     */
+    size_t nextBlockWithLevels( size_t pos, uint8_t levels ) const
+    {
+        auto it = std::upper_bound( index.begin(),
+                                    index.end(),
+                                    pos,
+                                    []( size_t offset, const IndexEntry& entry ) { return offset < entry.offset; } );
+        // Before the first record there is nothing to skip
+        if ( it == index.begin() ) return pos;
+
+        for ( --it; it != index.end(); ++it )
+        {
+            if ( ( it->levels & levels ) != 0u ) return std::max( pos, it->offset );
+        }
+        return data.size();
+    }
+
+    /**
+     * Narrow the range of the file to scan using the index.
+     * Records are written in time order, so the index is sorted on time.
+     */
+    std::pair<size_t, size_t> range( const std::optional<Timestamp>& from, const std::optional<Timestamp>& to ) const
+    {
+        size_t begin = 0u, end = data.size();
+        if ( from )
+        {
+            auto it = std::lower_bound( index.begin(),
+                                        index.end(),
+                                        *from,
+                                        []( const IndexEntry& entry, Timestamp time ) { return entry.timestamp < time; } );
+            if ( it != index.begin() ) begin = std::prev( it )->offset;
+        }
+        if ( to )
+        {
+            auto it = std::upper_bound( index.begin(),
+                                        index.end(),
+                                        *to,
+                                        []( Timestamp time, const IndexEntry& entry ) { return time < entry.timestamp; } );
+            if ( it != index.end() ) end = it->offset;
+        }
+        return { begin, std::max( begin, end ) };
+    }
+
+    std::vector<Match> search( const Query& query ) const
+    {
+        std::vector<Match> matches;
+        auto [begin, end] = range( query.from, query.to );
+
+        // Blocks without a record of a wanted level are skipped
+        uint8_t levels = 0xffu;
+        if ( query.minimumLevel )
+        {
+            levels = static_cast<uint8_t>( ~( levelBit( *query.minimumLevel ) - 1u ) );
+        }
+
+        auto accept = [&]( size_t recordStart, size_t recordEnd )
+        {
+            auto header = parseHeader( data, recordStart );
+            if ( !header ) return;
+            if ( query.from && header->timestamp < *query.from ) return;
+            if ( query.to && header->timestamp > *query.to ) return;
+            if ( query.minimumLevel && header->level < *query.minimumLevel ) return;
+
+            size_t length = recordEnd - recordStart;
+            if ( length > 0u && data[recordStart + length - 1u] == '\n' ) length--;
+            matches.push_back( { name, recordStart, header->timestamp, header->level, data.substr( recordStart, length ) } );
+        };
+        auto done = [&]() { return query.maxResults > 0u && matches.size() >= query.maxResults; };
+
+        std::string_view scope = data.substr( 0u, end );
+        if ( !query.text.empty() )
+        {
+            // Jump between occurrences of the text and only parse the records containing them
+            size_t pos = nextBlockWithLevels( begin, levels );
+            while ( !done() && ( pos = StringTools::find( scope, query.text, pos ) ) != std::string_view::npos )
+            {
+                size_t recordStart = recordStartBefore( scope, pos );
+                size_t recordEnd   = nextRecordStart( scope, pos + query.text.size() );
+                if ( recordStart >= begin && nextBlockWithLevels( recordStart, levels ) == recordStart )
+                {
+                    accept( recordStart, recordEnd );
+                }
+                pos = nextBlockWithLevels( recordEnd, levels );
+            }
+        }
+        else
+        {
+            for ( size_t recordStart = nextRecordStart( scope, begin ); recordStart < scope.size() && !done(); )
+            {
+                // Blocks start at records, so the next block with a wanted level does too
+                if ( size_t next = nextBlockWithLevels( recordStart, levels ); next != recordStart )
+                {
+                    recordStart = next;
+                    continue;
+                }
+                size_t recordEnd = nextRecordStart( scope, recordStart + 1u );
+                accept( recordStart, recordEnd );
+                recordStart = recordEnd;
+            }
+        }
+        return matches;
+    }
+
+    std::string                        name;
+    boost::interprocess::file_mapping  mapping;
+    boost::interprocess::mapped_region region;
+    std::string_view                   data;
+    std::vector<IndexEntry>            index;
+};
+
+LogSearch::LogSearch( const std::string& logFile, size_t indexStride )
+    : m_fileNames( rotatedFiles( logFile ) )
+{
+    for ( const auto& fileName : m_fileNames )
+    {
+        m_files.push_back( std::make_unique<MappedFile>( fileName, std::max( indexStride, size_t( 1u ) ) ) );
+    }
+}
+
+LogSearch::~LogSearch() = default;
+
+std::vector<LogSearch::Match> LogSearch::search( const Query& query ) const
+{
+    // A bounded number of workers take the files one at a time
+    std::vector<std::vector<Match>> fileMatches( m_files.size() );
+    std::atomic<size_t>             nextFile = 0u;
+
+    auto worker = [&]()
+    {
+        for ( size_t i = nextFile++; i < m_files.size(); i = nextFile++ )
+        {
+            fileMatches[i] = m_files[i]->search( query );
+        }
+    };
+
+    size_t workerCount = std::min<size_t>( m_files.size(), std::max( std::thread::hardware_concurrency(), 1u ) );
+
+    std::vector<std::future<void>> workers;
+    for ( size_t i = 1u; i < workerCount; ++i )
+    {
+        workers.push_back( std::async( std::launch::async, worker ) );
+    }
+    if ( workerCount > 0u ) worker();
+    for ( auto& fileSearch : workers )
+    {
+        fileSearch.get();
+    }
+
+    std::vector<Match> matches;
+    for ( const auto& matchesOfFile : fileMatches )
+    {
+        matches.insert( matches.end(), matchesOfFile.begin(), matchesOfFile.end() );
+    }
+    if ( query.maxResults > 0u && matches.size() > query.maxResults )
+    {
+        matches.resize( query.maxResults );
+    }
+    return matches;
+}
+
+const std::vector<std::string>& LogSearch::files() const
+{
+    return m_fileNames;
+}
+
+std::vector<std::string> LogSearch::rotatedFiles( const std::string& logFile )
+{
+    std::vector<std::string> files;
+    for ( size_t index = 0u;; ++index )
+    {
+        auto fileName = spdlog::sinks::rotating_file_sink_st::calc_filename( logFile, index );
+        if ( !std::filesystem::exists( fileName ) ) break;
+        files.push_back( fileName );
+    }
+    std::reverse( files.begin(), files.end() );
+    return files;
+}
+
+std::optional<LogSearch::Timestamp> LogSearch::parseTimestamp( std::string_view text )
+{
+    if ( text.size() < 19u || text[4] != '-' || text[7] != '-' || text[10] != ' ' || text[13] != ':' || text[16] != ':' )
+    {
+        return std::nullopt;
+    }
+
+    auto year   = parseNumber( text, 0u, 4u );
+    auto month  = parseNumber( text, 5u, 2u );
+    auto day    = parseNumber( text, 8u, 2u );
+    auto hour   = parseNumber( text, 11u, 2u );
+    auto minute = parseNumber( text, 14u, 2u );
+    auto second = parseNumber( text, 17u, 2u );
+    if ( !year || !month || !day || !hour || !minute || !second ) return std::nullopt;
+
+    int milliseconds = 0;
+    if ( text.size() >= 23u && text[19] == '.' )
+    {
+        auto fraction = parseNumber( text, 20u, 3u );
+        if ( !fraction ) return std::nullopt;
+        milliseconds = *fraction;
+    }
+
+    std::chrono::year_month_day date{ std::chrono::year( *year ),
+                                      std::chrono::month( static_cast<unsigned>( *month ) ),
+                                      std::chrono::day( static_cast<unsigned>( *day ) ) };
+    if ( !date.ok() ) return std::nullopt;
+
+    return std::chrono::sys_days( date ) + std::chrono::hours( *hour ) + std::chrono::minutes( *minute ) +
+           std::chrono::seconds( *second ) + std::chrono::milliseconds( milliseconds );
+}
@@ -0,0 +1,95 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "cafLogger.h"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * Fast searching of a set of rotated caffa log files (base.log, base.1.log, ...) without reading them into memory.
+ *
+ * The files are memory mapped and a sparse index of timestamps and levels is built for each, so time range
+ * queries only scan the part of the files covering the range, and level queries skip blocks without a record
+ * of a wanted level. Files are searched in parallel by at most one worker per hardware thread.
+ * Records are expected to start with a "[%Y-%m-%d %H:%M:%S.%e]" timestamp followed by bracketed fields that
+ * include the level, as in the default pattern. Lines without a timestamp belong to the record before them.
+ * Timestamps are compared as written in the files, without any time zone conversion.
+ */
+class LogSearch
+{
+public:
+    using Timestamp = std::chrono::sys_time<std::chrono::milliseconds>;
+
+    struct Query
+    {
+        std::optional<Timestamp>     from;           ///< Records at or after this time
+        std::optional<Timestamp>     to;             ///< Records at or before this time
+        std::optional<Logger::Level> minimumLevel;   ///< Records of this level or more severe
+        std::string                  text;           ///< Records containing this text
+        size_t                       maxResults = 0; ///< Stop after this many records. Zero means no limit.
+    };
+
+    struct Match
+    {
+        std::string      file;
+        size_t           offset;
+        Timestamp        timestamp;
+        Logger::Level    level;
+        std::string_view record; ///< The full record without the trailing line break. Valid while the search lives.
+    };
+
+    explicit LogSearch( const std::string& logFile, size_t indexStride = 64u * 1024u );
+    ~LogSearch();
+
+    /**
+     * Find matching records in chronological order, from the oldest rotated file to the current one
+     */
+    std::vector<Match> search( const Query& query ) const;
+
+    const std::vector<std::string>& files() const;
+
+    /**
+     * The existing rotated files of a log, oldest first, as named by the rotating file sink
+     */
+    static std::vector<std::string> rotatedFiles( const std::string& logFile );
+
+    /**
+     * Parse a "%Y-%m-%d %H:%M:%S" timestamp with optional ".%e" milliseconds
+     */
+    static std::optional<Timestamp> parseTimestamp( std::string_view text );
+
+private:
+    struct MappedFile;
+
+    std::vector<std::string>                 m_fileNames;
+    std::vector<std::unique_ptr<MappedFile>> m_files;
+};
+
+} // namespace caffa
@@ -19,16 +19,29 @@
 // ##################################################################################################
 #include "cafLogger.h"
 
+#include "cafPerThreadFileSink.h"
+#include "cafProbes.h"
+#include "cafQueuedSink.h"
+#include "cafTimerService.h"
+#ifdef CAFFA_WITH_ZSTD
+#include "cafCompressedFileSink.h"
+#endif
 #include "cafStringTools.h"
 
+#include "spdlog/async_logger.h"
+#include "spdlog/details/thread_pool.h"
 #include "spdlog/sinks/base_sink.h"
 #include "spdlog/sinks/ostream_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdio>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -40,9 +53,234 @@ using namespace caffa;
 
 std::function<std::string( std::string )> Logger::s_functionNameReplacer = nullptr;
 
+std::mutex                                          Logger::s_mutex;
+std::map<Logger::WorkerThread, ThreadConfiguration> Logger::s_workerThreadConfigurations;
+uint64_t                                            Logger::s_flushTimer = 0u;
+
+std::vector<std::shared_ptr<spdlog::details::thread_pool>> Logger::s_asyncWorkers;
+std::vector<std::shared_ptr<spdlog::details::thread_pool>> Logger::s_retiredAsyncWorkers;
+Logger::OverflowPolicy                                     Logger::s_asyncOverflowPolicy = OverflowPolicy::block;
+size_t                                                     Logger::s_nextAsyncWorker     = 0u;
+std::map<std::string, Logger::AsyncLoggerWorker>           Logger::s_asyncLoggerWorkers;
+
+std::mutex                                                Logger::s_refreshLevelsMutex;
+std::deque<std::atomic<Logger::Level>>                    Logger::s_effectiveLevelSlots;
+std::vector<std::unique_ptr<Logger::EffectiveLevelTable>> Logger::s_effectiveLevelTables;
+std::atomic<const Logger::EffectiveLevelTable*>           Logger::s_effectiveLevelTable   = nullptr;
+std::atomic<Logger::Level>                                Logger::s_defaultEffectiveLevel = Logger::Level::trace;
+std::atomic<Logger::Level>                                Logger::s_lowestEffectiveLevel  = Logger::Level::trace;
+
+std::atomic<LogCallSite*> LogCallSite::s_firstCallSite = nullptr;
+
+namespace
+{
+/**
+ * Reaches the protected parts of spdlog::logger, so records passed on by Logger get the same backtrace and error
+ * handling as records logged through spdlog. Never instantiated.
+ */
+struct LoggerInternals : spdlog::logger
+{
+    static void logIt( spdlog::logger& logger, const spdlog::details::log_msg& msg )
+    {
+        ( logger.*&LoggerInternals::log_it_ )( msg, true, logger.should_backtrace() );
+    }
+    static void backtrace( spdlog::logger& logger, const spdlog::details::log_msg& msg )
+    {
+        ( logger.*&LoggerInternals::tracer_ ).push_back( msg );
+    }
+    static void handleError( spdlog::logger& logger, const std::string& message )
+    {
+        ( logger.*&LoggerInternals::err_handler_ )( message );
+    }
+};
+
+// Bumped whenever loggers may have been created or changed, which invalidates the cached routes below
+std::atomic<uint64_t> s_routeGeneration = 1u;
+
+/**
+ * How records of a logger are passed on, resolved once per logger and thread rather than for every record
+ */
+struct LoggerRoute
+{
+    const spdlog::logger*       logger     = nullptr;
+    uint64_t                    generation = 0u;
+    bool                        async      = false;
+    const spdlog::sinks::sink* queuedSink = nullptr; ///< The last sink if it is a QueuedSink
+};
+
+const LoggerRoute& loggerRoute( const spdlog::logger* logger )
+{
+    thread_local std::array<LoggerRoute, 8> t_routes;
+
+    auto  generation = s_routeGeneration.load( std::memory_order_acquire );
+    auto& route      = t_routes[( reinterpret_cast<uintptr_t>( logger ) >> 4u ) % t_routes.size()];
+    if ( route.logger != logger || route.generation != generation )
+    {
+        const auto& sinks = logger->sinks();
+        route.logger      = logger;
+        route.generation  = generation;
+        route.async       = dynamic_cast<const spdlog::async_logger*>( logger ) != nullptr;
+        route.queuedSink  = !sinks.empty() && dynamic_cast<QueuedSink*>( sinks.back().get() ) ? sinks.back().get()
+                                                                                               : nullptr;
+    }
+    return route;
+}
+
+/**
+ * Pass the message to the sinks of a synchronous logger directly, as spdlog::logger::sink_it_ does.
+ * The last sink takes over the movable message, since no other sink will look at the message after it.
+ */
+void logToSinks( spdlog::logger&           logger,
+                 const LoggerRoute&        route,
+                 spdlog::level::level_enum level,
+                 std::string_view          message,
+                 std::string&              movableMessage )
+{
+    spdlog::details::log_msg msg( spdlog::source_loc{}, logger.name(), level, message );
+    if ( logger.should_backtrace() )
+    {
+        // Before the message is moved away
+        LoggerInternals::backtrace( logger, msg );
+    }
+
+    const auto& sinks = logger.sinks();
+    for ( const auto& sink : sinks )
+    {
+        if ( !sink->should_log( level ) ) continue;
+
+        try
+        {
+            if ( sink.get() == route.queuedSink && &sink == &sinks.back() )
+            {
+                static_cast<QueuedSink*>( sink.get() )->log( msg, std::move( movableMessage ) );
+            }
+            else
+            {
+                sink->log( msg );
+            }
+        }
+        catch ( const std::exception& e )
+        {
+            LoggerInternals::handleError( logger, e.what() );
+        }
+        catch ( ... )
+        {
+            LoggerInternals::handleError( logger, "Rethrowing unknown exception in logger" );
+            throw;
+        }
+    }
+    if ( level >= logger.flush_level() )
+    {
+        logger.flush();
+    }
+}
+
+spdlog::async_overflow_policy asyncOverflowPolicy( Logger::OverflowPolicy overflowPolicy )
+{
+    switch ( overflowPolicy )
+    {
+        case Logger::OverflowPolicy::block:
+            return spdlog::async_overflow_policy::block;
+        case Logger::OverflowPolicy::discardNew:
+            return spdlog::async_overflow_policy::discard_new;
+        case Logger::OverflowPolicy::overrunOldest:
+        case Logger::OverflowPolicy::shedByLevel:
+            break;
+    }
+    return spdlog::async_overflow_policy::overrun_oldest;
+}
+
+Logger::Level effectiveLevel( const spdlog::logger& logger )
+{
+    auto lowestSinkLevel = spdlog::level::off;
+    for ( const auto& sink : logger.sinks() )
+    {
+        if ( auto queuedSink = dynamic_cast<QueuedSink*>( sink.get() ); queuedSink )
+        {
+            // The wrapped sink may have had its level set directly
+            queuedSink->refreshLevel();
+        }
+        lowestSinkLevel = std::min( lowestSinkLevel, sink->level() );
+    }
+    return static_cast<Logger::Level>( std::max( logger.level(), lowestSinkLevel ) );
+}
+
+std::shared_ptr<spdlog::details::thread_pool> createAsyncWorker( size_t                     queueSize,
+                                                                const ThreadConfiguration& configuration )
+{
+    auto onThreadStart = [configuration]() { configuration.applyToCurrentThread(); };
+    if ( configuration.cpus.empty() )
+    {
+        return std::make_shared<spdlog::details::thread_pool>( queueSize, 1u, onThreadStart );
+    }
+
+    // The queue is allocated and first touched in the constructor, so construct the pool on a thread pinned like the
+    // worker to get the queue on the NUMA node of the worker
+    std::shared_ptr<spdlog::details::thread_pool> threadPool;
+    std::exception_ptr                            error;
+    std::thread(
+        [&]()
+        {
+            try
+            {
+                configuration.applyToCurrentThread();
+                threadPool = std::make_shared<spdlog::details::thread_pool>( queueSize, 1u, onThreadStart );
+            }
+            catch ( ... )
+            {
+                error = std::current_exception();
+            }
+        } )
+        .join();
+    if ( error ) std::rethrow_exception( error );
+    return threadPool;
+}
+
+std::shared_ptr<spdlog::logger> loggerOrDefault( const std::string& loggerName )
+{
+    std::shared_ptr<spdlog::logger> logger = loggerName.empty() ? nullptr : spdlog::get( loggerName );
+    if ( !logger ) logger = spdlog::default_logger();
+    return logger;
+}
+
+bool globMatch( std::string_view pattern, std::string_view text )
+{
+    size_t patternPos = 0u, textPos = 0u;
+    size_t starPos = std::string_view::npos, starTextPos = 0u;
+    while ( textPos < text.size() )
+    {
+        if ( patternPos < pattern.size() && ( pattern[patternPos] == '?' || pattern[patternPos] == text[textPos] ) )
+        {
+            patternPos++;
+            textPos++;
+        }
+        else if ( patternPos < pattern.size() && pattern[patternPos] == '*' )
+        {
+            starPos     = patternPos++;
+            starTextPos = textPos;
+        }
+        else if ( starPos != std::string_view::npos )
+        {
+            patternPos = starPos + 1u;
+            textPos    = ++starTextPos;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while ( patternPos < pattern.size() && pattern[patternPos] == '*' )
+    {
+        patternPos++;
+    }
+    return patternPos == pattern.size();
+}
+} // namespace
+
 void Logger::setApplicationLogLevel( Logger::Level applicationLogLevel )
 {
     spdlog::set_level( static_cast<spdlog::level::level_enum>( applicationLogLevel ) );
+    refreshEffectiveLevels();
 }
 
 void Logger::setLogLevel( const std::string& loggerName, Logger::Level logLevel )
@@ -51,6 +289,93 @@ void Logger::setLogLevel( const std::string& loggerName, Logger::Level logLevel
     if ( !logger ) logger = spdlog::default_logger();
 
     logger->set_level( static_cast<spdlog::level::level_enum>( logLevel ) );
+    refreshEffectiveLevels();
+}
+
+void Logger::setSinkLevel( std::shared_ptr<spdlog::sinks::sink> sink, Level level )
+{
+    if ( auto queuedSink = std::dynamic_pointer_cast<QueuedSink>( sink ); queuedSink )
+    {
+        queuedSink->set_level( static_cast<spdlog::level::level_enum>( level ) );
+    }
+    else
+    {
+        sink->set_level( static_cast<spdlog::level::level_enum>( level ) );
+    }
+    refreshEffectiveLevels();
+}
+
+void Logger::refreshEffectiveLevels()
+{
+    s_routeGeneration.fetch_add( 1u, std::memory_order_release );
+
+    // Held while computing too, so a refresh that read older levels cannot publish after a newer one
+    std::scoped_lock refreshLock( s_refreshLevelsMutex );
+
+    std::map<std::string, Level, std::less<>> effectiveLevels;
+    spdlog::apply_all( [&effectiveLevels]( std::shared_ptr<spdlog::logger> logger )
+                       { effectiveLevels[logger->name()] = effectiveLevel( *logger ); } );
+
+    auto defaultLevel = effectiveLevel( *spdlog::default_logger_raw() );
+    auto lowestLevel  = defaultLevel;
+    for ( const auto& [name, level] : effectiveLevels )
+    {
+        lowestLevel = std::min( lowestLevel, level );
+        addEffectiveLevel( name, level );
+    }
+
+    // The lowest level is lowered before and raised after the levels of the loggers, so it never holds back a record
+    // that the level of its logger lets through
+    s_lowestEffectiveLevel = std::min( s_lowestEffectiveLevel.load(), lowestLevel );
+    if ( auto table = s_effectiveLevelTable.load( std::memory_order_acquire ); table )
+    {
+        for ( const auto& [name, slot] : *table )
+        {
+            // Loggers that have been dropped fall back to the default logger, as in log()
+            auto it = effectiveLevels.find( name );
+            slot->store( it != effectiveLevels.end() ? it->second : defaultLevel, std::memory_order_relaxed );
+        }
+    }
+    s_defaultEffectiveLevel = defaultLevel;
+    s_lowestEffectiveLevel  = lowestLevel;
+}
+
+const std::atomic<Logger::Level>& Logger::effectiveLevelOf( std::string_view loggerName )
+{
+    if ( loggerName.empty() ) return s_defaultEffectiveLevel;
+
+    if ( auto table = s_effectiveLevelTable.load( std::memory_order_acquire ); table )
+    {
+        if ( auto it = table->find( loggerName ); it != table->end() )
+        {
+            return *it->second;
+        }
+    }
+
+    std::scoped_lock lock( s_refreshLevelsMutex );
+    auto             logger = spdlog::get( std::string( loggerName ) );
+    auto             level  = logger ? effectiveLevel( *logger ) : s_defaultEffectiveLevel.load( std::memory_order_relaxed );
+    return addEffectiveLevel( loggerName, level );
+}
+
+std::atomic<Logger::Level>& Logger::addEffectiveLevel( std::string_view loggerName, Level level )
+{
+    auto table = s_effectiveLevelTable.load( std::memory_order_relaxed );
+    if ( table )
+    {
+        if ( auto it = table->find( loggerName ); it != table->end() )
+        {
+            return *it->second;
+        }
+    }
+
+    auto& slot = s_effectiveLevelSlots.emplace_back( level );
+
+    auto newTable = table ? std::make_unique<EffectiveLevelTable>( *table ) : std::make_unique<EffectiveLevelTable>();
+    newTable->emplace( std::string( loggerName ), &slot );
+    s_effectiveLevelTable.store( newTable.get(), std::memory_order_release );
+    s_effectiveLevelTables.push_back( std::move( newTable ) );
+    return slot;
 }
 
 std::map<Logger::Level, std::string> Logger::logLevels()
@@ -81,8 +406,12 @@ void Logger::registerDefaultFileLogger( const std::string& logFile,
                                         size_t             maxFileSizeMiB /*= 5u */,
                                         size_t             maxRotatedFiles /*= 3u */ )
 {
-    auto logger = spdlog::rotating_logger_mt( "default", logFile, maxFileSizeMiB * 1024u * 1024u, maxRotatedFiles, true );
-    spdlog::set_default_logger( logger );
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>( logFile,
+                                                                        maxFileSizeMiB * 1024u * 1024u,
+                                                                        maxRotatedFiles,
+                                                                        true );
+    spdlog::set_default_logger( createLogger( "default", { sink } ) );
+    refreshEffectiveLevels();
 }
 
 void Logger::registerFileLogger( const std::string& logFile,
@@ -90,28 +419,49 @@ void Logger::registerFileLogger( const std::string& logFile,
                                  size_t             maxFileSizeMiB /*= 5u */,
                                  size_t             maxRotatedFiles /*= 3u */ )
 {
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>( logFile,
+                                                                        maxFileSizeMiB * 1024u * 1024u,
+                                                                        maxRotatedFiles,
+                                                                        true );
+
     std::shared_ptr<spdlog::logger> logger = spdlog::get( loggerName );
     if ( logger )
     {
-        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>( logFile,
-                                                                            maxFileSizeMiB * 1024u * 1024u,
-                                                                            maxRotatedFiles,
-                                                                            true );
         logger->sinks().push_back( sink );
     }
     else
     {
-        logger = spdlog::rotating_logger_mt( loggerName, logFile, maxFileSizeMiB * 1024u * 1024u, maxRotatedFiles, true );
+        createLogger( loggerName, { sink } );
     }
+    refreshEffectiveLevels();
+}
+
+#ifdef CAFFA_WITH_ZSTD
+void Logger::registerCompressedFileLogger( const std::string& logFile,
+                                           const std::string& loggerName,
+                                           size_t             maxFileSizeMiB /*= 5u */,
+                                           size_t             maxRotatedFiles /*= 3u */ )
+{
+    registerCustomSink( loggerName,
+                        std::make_shared<CompressedRotatingFileSink>( logFile,
+                                                                      maxFileSizeMiB * 1024u * 1024u,
+                                                                      maxRotatedFiles ) );
+}
+#endif
+
+void Logger::registerPerThreadFileLogger( const std::string& logFile, const std::string& loggerName )
+{
+    registerCustomSink( loggerName, std::make_shared<PerThreadFileSink>( logFile ) );
 }
 
 void Logger::registerStdOutLogger( const std::string& loggerName )
 {
-    auto logger = spdlog::stdout_color_mt( loggerName );
+    auto logger = createLogger( loggerName, { std::make_shared<spdlog::sinks::stdout_color_sink_mt>() } );
     if ( loggerName == "default" )
     {
         spdlog::set_default_logger( logger );
     }
+    refreshEffectiveLevels();
 }
 
 void Logger::registerCustomSink( const std::string& loggerName, std::shared_ptr<spdlog::sinks::sink> sink )
@@ -119,23 +469,256 @@ void Logger::registerCustomSink( const std::string& loggerName, std::shared_ptr<
     std::shared_ptr<spdlog::logger> logger = spdlog::get( loggerName );
     if ( !logger )
     {
-        logger = std::make_shared<spdlog::logger>( loggerName );
-        spdlog::register_logger( logger );
+        logger = createLogger( loggerName, {} );
     }
     logger->sinks().push_back( sink );
+    refreshEffectiveLevels();
 }
 
-void Logger::log( const std::string& loggerName, Level level, const std::string& message )
+void Logger::registerQueuedSink( const std::string&                   loggerName,
+                                 std::shared_ptr<spdlog::sinks::sink> sink,
+                                 size_t                               queueSize /*= 8192u */,
+                                 OverflowPolicy                       overflowPolicy /*= OverflowPolicy::discardNew */ )
+{
+    registerCustomSink( loggerName, std::make_shared<QueuedSink>( sink, queueSize, overflowPolicy ) );
+}
+
+size_t Logger::droppedMessages( const std::string& loggerName )
 {
     std::shared_ptr<spdlog::logger> logger = spdlog::get( loggerName );
-    if ( !logger ) logger = spdlog::default_logger();
+    if ( !logger ) return 0u;
 
-    logger->log( static_cast<spdlog::level::level_enum>( level ), message );
+    size_t dropped = 0u;
+    for ( const auto& sink : logger->sinks() )
+    {
+        if ( auto queuedSink = std::dynamic_pointer_cast<QueuedSink>( sink ); queuedSink )
+        {
+            dropped += queuedSink->droppedCount();
+        }
+    }
+    return dropped;
 }
-void Logger::log( Level level, const std::string& message )
+
+void Logger::enableAsyncLogging( size_t workerCount, size_t queueSize, OverflowPolicy overflowPolicy )
+{
+    auto configuration = workerThreadConfiguration( WorkerThread::asyncLogger );
+
+    std::vector<std::shared_ptr<spdlog::details::thread_pool>> unusedWorkers;
+    {
+        std::scoped_lock lock( s_mutex );
+        // Async loggers only hold weak references to their worker, so the workers of earlier loggers are kept alive
+        s_retiredAsyncWorkers.insert( s_retiredAsyncWorkers.end(), s_asyncWorkers.begin(), s_asyncWorkers.end() );
+        s_asyncWorkers.clear();
+        for ( size_t i = 0; i < workerCount; ++i )
+        {
+            // A single thread per pool keeps the records of each logger in order
+            s_asyncWorkers.push_back( createAsyncWorker( std::max( queueSize, size_t( 1u ) ), configuration ) );
+        }
+        s_asyncOverflowPolicy = overflowPolicy;
+        s_nextAsyncWorker     = 0u;
+        unusedWorkers         = takeUnusedAsyncWorkers();
+    }
+    // Joins the worker threads once they have written out their queue, which may log and so needs the lock released
+    unusedWorkers.clear();
+}
+
+std::vector<std::shared_ptr<spdlog::details::thread_pool>> Logger::takeUnusedAsyncWorkers()
+{
+    std::erase_if( s_asyncLoggerWorkers, []( const auto& entry ) { return entry.second.logger.expired(); } );
+
+    std::vector<std::shared_ptr<spdlog::details::thread_pool>> unusedWorkers;
+    std::erase_if( s_retiredAsyncWorkers,
+                   [&unusedWorkers]( const std::shared_ptr<spdlog::details::thread_pool>& threadPool )
+                   {
+                       bool used = std::any_of( s_asyncLoggerWorkers.begin(),
+                                                s_asyncLoggerWorkers.end(),
+                                                [&threadPool]( const auto& entry )
+                                                { return entry.second.threadPool.lock() == threadPool; } );
+                       if ( !used ) unusedWorkers.push_back( threadPool );
+                       return !used;
+                   } );
+    return unusedWorkers;
+}
+
+std::map<Logger::Level, size_t> Logger::droppedMessagesPerLevel( const std::string& loggerName )
+{
+    std::map<Level, size_t> dropped;
+    for ( int level = 0; level < static_cast<int>( Level::n_levels ); ++level )
+    {
+        dropped[static_cast<Level>( level )] = 0u;
+    }
+
+    std::shared_ptr<spdlog::logger> logger = spdlog::get( loggerName );
+    if ( !logger ) return dropped;
+
+    for ( const auto& sink : logger->sinks() )
+    {
+        if ( auto queuedSink = std::dynamic_pointer_cast<QueuedSink>( sink ); queuedSink )
+        {
+            for ( auto [level, count] : queuedSink->droppedCountPerLevel() )
+            {
+                dropped[level] += count;
+            }
+        }
+    }
+    return dropped;
+}
+
+void Logger::log( const std::string& loggerName, Level level, std::string_view message, bool bypassLoggerLevel )
+{
+    auto logger = loggerOrDefault( loggerName );
+    logToLogger( logger.get(), level, message, nullptr, bypassLoggerLevel );
+}
+
+void Logger::log( const std::string& loggerName, Level level, std::string&& message, bool bypassLoggerLevel )
+{
+    auto logger = loggerOrDefault( loggerName );
+    logToLogger( logger.get(), level, message, &message, bypassLoggerLevel );
+}
+
+void Logger::log( Level level, std::string_view message, bool bypassLoggerLevel )
 {
-    std::shared_ptr<spdlog::logger> logger = spdlog::default_logger();
-    logger->log( static_cast<spdlog::level::level_enum>( level ), message );
+    logToLogger( spdlog::default_logger_raw(), level, message, nullptr, bypassLoggerLevel );
+}
+
+void Logger::log( Level level, std::string&& message, bool bypassLoggerLevel )
+{
+    logToLogger( spdlog::default_logger_raw(), level, message, &message, bypassLoggerLevel );
+}
+
+std::shared_ptr<spdlog::logger> Logger::findLogger( const std::string& loggerName )
+{
+    return spdlog::get( loggerName );
+}
+
+bool Logger::shouldLog( const std::shared_ptr<spdlog::logger>& logger, Level level )
+{
+    return level >= s_lowestEffectiveLevel.load( std::memory_order_relaxed ) &&
+           loggerShouldLog( logger ? std::string_view( logger->name() ) : std::string_view(), level );
+}
+
+bool Logger::loggerShouldLog( std::string_view loggerName, Level level )
+{
+    if ( !loggerName.empty() )
+    {
+        if ( auto table = s_effectiveLevelTable.load( std::memory_order_acquire ); table )
+        {
+            if ( auto it = table->find( loggerName ); it != table->end() )
+            {
+                return level >= it->second->load( std::memory_order_relaxed );
+            }
+        }
+    }
+    // Not registered, which log() treats as the default logger
+    return level >= s_defaultEffectiveLevel.load( std::memory_order_relaxed );
+}
+
+void Logger::log( const std::shared_ptr<spdlog::logger>& logger,
+                  Level                                  level,
+                  std::string_view                       message,
+                  bool                                   bypassLoggerLevel )
+{
+    logToLogger( logger ? logger.get() : spdlog::default_logger_raw(), level, message, nullptr, bypassLoggerLevel );
+}
+
+void Logger::log( const std::shared_ptr<spdlog::logger>& logger,
+                  Level                                  level,
+                  std::string&&                          message,
+                  bool                                   bypassLoggerLevel )
+{
+    logToLogger( logger ? logger.get() : spdlog::default_logger_raw(), level, message, &message, bypassLoggerLevel );
+}
+
+void Logger::setWorkerThreadConfiguration( WorkerThread worker, const ThreadConfiguration& configuration )
+{
+    {
+        std::scoped_lock lock( s_mutex );
+        s_workerThreadConfigurations[worker] = configuration;
+    }
+    if ( worker == WorkerThread::periodicFlush )
+    {
+        applyFlushThreadConfiguration();
+    }
+}
+
+ThreadConfiguration Logger::workerThreadConfiguration( WorkerThread worker )
+{
+    std::scoped_lock lock( s_mutex );
+    if ( auto it = s_workerThreadConfigurations.find( worker ); it != s_workerThreadConfigurations.end() )
+    {
+        return it->second;
+    }
+    return ThreadConfiguration();
+}
+
+std::shared_ptr<spdlog::logger> Logger::createLogger( const std::string&                                 loggerName,
+                                                      std::vector<std::shared_ptr<spdlog::sinks::sink>> sinks )
+{
+    std::shared_ptr<spdlog::logger> logger;
+    {
+        std::scoped_lock lock( s_mutex );
+        if ( s_asyncWorkers.empty() )
+        {
+            logger = std::make_shared<spdlog::logger>( loggerName, sinks.begin(), sinks.end() );
+        }
+        else
+        {
+            auto threadPool = s_asyncWorkers[s_nextAsyncWorker++ % s_asyncWorkers.size()];
+            logger          = std::make_shared<spdlog::async_logger>( loggerName,
+                                                             sinks.begin(),
+                                                             sinks.end(),
+                                                             threadPool,
+                                                             asyncOverflowPolicy( s_asyncOverflowPolicy ) );
+            s_asyncLoggerWorkers[loggerName] = AsyncLoggerWorker{ threadPool, logger };
+        }
+    }
+    spdlog::initialize_logger( logger );
+    s_routeGeneration.fetch_add( 1u, std::memory_order_release );
+    return logger;
+}
+
+void Logger::logToLogger( spdlog::logger*  logger,
+                          Level            level,
+                          std::string_view message,
+                          std::string*     movableMessage,
+                          bool             bypassLoggerLevel )
+{
+    auto level_enum = static_cast<spdlog::level::level_enum>( level );
+    CAFFA_PROBE( log_entry, logger->name().c_str(), static_cast<int>( level ), message.size() );
+
+    if ( !bypassLoggerLevel && !movableMessage )
+    {
+        logger->log( level_enum, message );
+        CAFFA_PROBE( log_return, logger->name().c_str(), static_cast<int>( level ) );
+        return;
+    }
+
+    const auto& route = loggerRoute( logger );
+    if ( movableMessage && route.queuedSink && !route.async &&
+         ( bypassLoggerLevel || logger->should_log( level_enum ) ) )
+    {
+        // Moved into the queue slot of the sink. Async loggers copy the message into their worker queue instead.
+        logToSinks( *logger, route, level_enum, message, *movableMessage );
+    }
+    else if ( bypassLoggerLevel )
+    {
+        // Only skips the level of the logger. Records of async loggers go through their worker queue to stay in order.
+        spdlog::details::log_msg msg( spdlog::source_loc{}, logger->name(), level_enum, message );
+        LoggerInternals::logIt( *logger, msg );
+    }
+    else
+    {
+        logger->log( level_enum, message );
+    }
+    CAFFA_PROBE( log_return, logger->name().c_str(), static_cast<int>( level ) );
+}
+
+void Logger::applyFlushThreadConfiguration()
+{
+    if ( !TimerService::setThreadConfiguration( workerThreadConfiguration( WorkerThread::periodicFlush ) ) )
+    {
+        CAFFA_WARNING( "Could not apply the thread configuration to the periodic flush thread" );
+    }
 }
 
 void Logger::set_default_pattern( const std::string& pattern )
@@ -144,7 +727,27 @@ void Logger::set_default_pattern( const std::string& pattern )
 }
 void Logger::set_default_flush_interval( std::chrono::seconds seconds )
 {
-    spdlog::flush_every( seconds );
+    // Runs on the shared timer service rather than spdlog::flush_every, which starts a thread of its own
+    uint64_t timer = 0u;
+    if ( seconds.count() > 0 )
+    {
+        timer = TimerService::scheduleRepeating( seconds,
+                                                 []()
+                                                 {
+                                                     spdlog::apply_all( []( std::shared_ptr<spdlog::logger> logger )
+                                                                        { logger->flush(); } );
+                                                 } );
+    }
+
+    uint64_t previousTimer = 0u;
+    {
+        std::scoped_lock lock( s_mutex );
+        previousTimer = std::exchange( s_flushTimer, timer );
+    }
+    if ( previousTimer )
+    {
+        TimerService::cancel( previousTimer );
+    }
 }
 
 void Logger::set_default_flush_level( Level level )
@@ -181,3 +784,47 @@ void Logger::setFunctionNameReplacer( std::function<std::string( std::string )>
 {
     s_functionNameReplacer = functionNameReplacer;
 }
+
+LogCallSite::LogCallSite( const char* file, const char* function, int line, Logger::Level level )
+    : m_file( file )
+    , m_function( function )
+    , m_line( line )
+    , m_level( level )
+    , m_state( State::automatic )
+    , m_next( s_firstCallSite.load( std::memory_order_relaxed ) )
+{
+    // Call sites are never removed, so a plain push onto the front of the list is enough
+    while (
+        !s_firstCallSite.compare_exchange_weak( m_next, this, std::memory_order_release, std::memory_order_relaxed ) )
+    {
+    }
+}
+
+std::vector<LogCallSite*> LogCallSite::callSites()
+{
+    std::vector<LogCallSite*> callSites;
+    for ( auto callSite = s_firstCallSite.load( std::memory_order_acquire ); callSite; callSite = callSite->m_next )
+    {
+        callSites.push_back( callSite );
+    }
+    return callSites;
+}
+
+size_t
+    LogCallSite::setState( const std::string& filePattern, const std::string& functionPattern, int line, State state )
+{
+    size_t matches = 0u;
+    for ( auto callSite : callSites() )
+    {
+        std::string_view file      = callSite->file();
+        bool             fileMatch = filePattern.empty() || globMatch( filePattern, file ) ||
+                         globMatch( filePattern, std::filesystem::path( file ).filename().string() );
+        bool             functionMatch = functionPattern.empty() || globMatch( functionPattern, callSite->function() );
+        if ( fileMatch && functionMatch && ( line == 0 || line == callSite->line() ) )
+        {
+            callSite->setState( state );
+            matches++;
+        }
+    }
+    return matches;
+}
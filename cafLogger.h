@@ -19,18 +19,45 @@
 // ##################################################################################################
 #pragma once
 
+#include "cafFixedString.h"
+#include "cafThreadConfiguration.h"
+
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
-namespace spdlog::sinks
+namespace spdlog
+{
+class logger;
+namespace details
 {
-class sink;
+    class thread_pool;
 }
+namespace sinks
+{
+    class sink;
+}
+} // namespace spdlog
+
+/**
+ * Global compile-time minimum level for log categories (see CAFFA_LOG). Defaults to
+ * stripping trace statements from release builds, like CAFFA_TRACE.
+ */
+#ifndef CAFFA_LOG_MINIMUM_LEVEL
+#ifdef NDEBUG
+#define CAFFA_LOG_MINIMUM_LEVEL 1
+#else
+#define CAFFA_LOG_MINIMUM_LEVEL 0
+#endif
+#endif
 
 namespace caffa
 {
@@ -49,9 +76,66 @@ public:
         n_levels
     };
 
+    /**
+     * What a queued sink does with new records when its queue is full.
+     * shedByLevel starts dropping the lower levels before the queue is full and always admits critical records.
+     */
+    enum class OverflowPolicy
+    {
+        block,
+        overrunOldest,
+        discardNew,
+        shedByLevel
+    };
+
+    /**
+     * Background threads started for logging
+     */
+    enum class WorkerThread
+    {
+        queuedSink,    ///< The drain workers of queued sinks. Log file rotation happens on these for queued file sinks.
+        periodicFlush, ///< The timer service thread, which flushes all loggers at the default flush interval
+        asyncLogger,   ///< The workers formatting and writing records of asynchronous loggers
+        compression    ///< The workers compressing the frames of compressed file sinks
+    };
+
     static void setApplicationLogLevel( Level applicationLogLevel );
     static void setLogLevel( const std::string& loggerName, Level applicationLogLevel );
 
+    /**
+     * Set the level of a sink and update the effective levels of the loggers using it
+     */
+    static void setSinkLevel( std::shared_ptr<spdlog::sinks::sink> sink, Level level );
+
+    /**
+     * The effective level of a logger is the higher of its own level and the lowest level of its sinks, below which
+     * no sink would write a record. The logging macros check it before building the message.
+     * Effective levels are kept up to date by the functions of this class. Call refreshEffectiveLevels after
+     * changing loggers, sinks or levels directly through spdlog.
+     */
+    static void refreshEffectiveLevels();
+
+    /**
+     * Whether a record of the given level would be written by any sink of the logger.
+     * Loggers that are not registered fall back to the default logger, as in log(), as does an empty name.
+     */
+    static bool shouldLog( std::string_view loggerName, Level level )
+    {
+        return level >= s_lowestEffectiveLevel.load( std::memory_order_relaxed ) &&
+               loggerShouldLog( loggerName, level );
+    }
+
+    /**
+     * The effective level of a logger, updated in place by refreshEffectiveLevels. The reference stays valid for the
+     * lifetime of the process, so a call site can look it up once and check it with the overload below.
+     * A logger that is not registered yet has the effective level of the default logger until it is.
+     */
+    static const std::atomic<Level>& effectiveLevelOf( std::string_view loggerName );
+    static bool                      shouldLog( const std::atomic<Level>& effectiveLevel, Level level )
+    {
+        return level >= effectiveLevel.load( std::memory_order_relaxed );
+    }
+
     static std::map<Level, std::string> logLevels();
     static Level                        logLevelFromLabel( const std::string& label );
 
@@ -61,11 +145,102 @@ public:
                                     const std::string& loggerName,
                                     size_t             maxFileSizeMiB  = 5u,
                                     size_t             maxRotatedFiles = 3u );
+#ifdef CAFFA_WITH_ZSTD
+    /**
+     * Register a zstd compressed rotating file logger (see CompressedRotatingFileSink).
+     * The maximum file size applies to the compressed size.
+     */
+    static void registerCompressedFileLogger( const std::string& logFile,
+                                              const std::string& loggerName,
+                                              size_t             maxFileSizeMiB  = 5u,
+                                              size_t             maxRotatedFiles = 3u );
+#endif
+    /**
+     * Register a logger writing a file per logging thread, merged afterwards by sequence number
+     * (see PerThreadFileSink). For capturing at rates where threads should not wait for a shared file.
+     */
+    static void registerPerThreadFileLogger( const std::string& logFile, const std::string& loggerName );
     static void registerStdOutLogger( const std::string& loggerName = "default" );
     static void registerCustomSink( const std::string& loggerName, std::shared_ptr<spdlog::sinks::sink> sink );
 
-    static void log( const std::string& loggerName, Level level, const std::string& message );
-    static void log( Level level, const std::string& message );
+    /**
+     * Register a sink that is fed from its own bounded queue and worker thread instead of the logging thread.
+     * Use it for sinks that may stall so they do not hold up the other sinks of the logger.
+     */
+    static void registerQueuedSink( const std::string&                   loggerName,
+                                    std::shared_ptr<spdlog::sinks::sink> sink,
+                                    size_t                               queueSize      = 8192u,
+                                    OverflowPolicy                       overflowPolicy = OverflowPolicy::discardNew );
+    static size_t                  droppedMessages( const std::string& loggerName );
+    static std::map<Level, size_t> droppedMessagesPerLevel( const std::string& loggerName );
+
+    /**
+     * Create the loggers registered from now on as asynchronous loggers served by workerCount worker threads.
+     * Each logger is bound to a single worker, handed out in turn, so the records of a logger stay in order
+     * while different loggers are formatted and written in parallel.
+     * Each worker has its own queue of queueSize records, allocated on the cores of WorkerThread::asyncLogger if
+     * that configuration pins the workers. OverflowPolicy::shedByLevel is handled as overrunOldest.
+     * Loggers registered before keep their worker. Call with a workerCount of 0 to create synchronous loggers again.
+     * Each call stops the workers that no longer serve a logger, once they have written out their queue.
+     */
+    static void enableAsyncLogging( size_t         workerCount,
+                                    size_t         queueSize      = 8192u,
+                                    OverflowPolicy overflowPolicy = OverflowPolicy::block );
+
+    /**
+     * Log a message. With bypassLoggerLevel set, the level of the logger is ignored and the message goes straight
+     * to the sinks, as for call sites switched on at runtime (see LogCallSite). Sink levels still apply.
+     *
+     * Messages passed as rvalues are moved into the queue slot if the last sink of the logger is a QueuedSink,
+     * so an already built message is not copied again on its way to the worker thread. Async loggers (see
+     * enableAsyncLogging) always copy the message into the queue of their worker, as spdlog owns those records.
+     */
+    static void
+        log( const std::string& loggerName, Level level, std::string_view message, bool bypassLoggerLevel = false );
+    static void
+        log( const std::string& loggerName, Level level, std::string&& message, bool bypassLoggerLevel = false );
+    static void
+        log( const std::string& loggerName, Level level, const char* message, bool bypassLoggerLevel = false )
+    {
+        log( loggerName, level, std::string_view( message ), bypassLoggerLevel );
+    }
+    static void log( Level level, std::string_view message, bool bypassLoggerLevel = false );
+    static void log( Level level, std::string&& message, bool bypassLoggerLevel = false );
+    static void log( Level level, const char* message, bool bypassLoggerLevel = false )
+    {
+        log( level, std::string_view( message ), bypassLoggerLevel );
+    }
+
+    /**
+     * Look up a registered logger once so it can be cached by the caller.
+     * Returns nullptr if no logger of that name is registered, in which case the
+     * logger-handle overloads below fall back to the default logger.
+     */
+    static std::shared_ptr<spdlog::logger> findLogger( const std::string& loggerName );
+    static bool shouldLog( const std::shared_ptr<spdlog::logger>& logger, Level level );
+    static void log( const std::shared_ptr<spdlog::logger>& logger,
+                     Level                                  level,
+                     std::string_view                       message,
+                     bool                                   bypassLoggerLevel = false );
+    static void log( const std::shared_ptr<spdlog::logger>& logger,
+                     Level                                  level,
+                     std::string&&                          message,
+                     bool                                   bypassLoggerLevel = false );
+    static void log( const std::shared_ptr<spdlog::logger>& logger,
+                     Level                                  level,
+                     const char*                            message,
+                     bool                                   bypassLoggerLevel = false )
+    {
+        log( logger, level, std::string_view( message ), bypassLoggerLevel );
+    }
+
+    /**
+     * Pin logging threads to cores and set their scheduling class and nice level.
+     * Queued sink workers pick up the configuration when they start, so set it before registering queued sinks.
+     * The timer service thread running the periodic flush is reconfigured right away.
+     */
+    static void                setWorkerThreadConfiguration( WorkerThread worker, const ThreadConfiguration& configuration );
+    static ThreadConfiguration workerThreadConfiguration( WorkerThread worker );
 
     static void set_default_pattern( const std::string& pattern );
     static void set_default_flush_interval( std::chrono::seconds seconds );
@@ -80,13 +255,137 @@ public:
     static void setFunctionNameReplacer( std::function<std::string( std::string )> functionNameReplacer );
 
 private:
+    static void applyFlushThreadConfiguration();
+    static bool loggerShouldLog( std::string_view loggerName, Level level );
+
+    static std::shared_ptr<spdlog::logger> createLogger( const std::string&                                 loggerName,
+                                                         std::vector<std::shared_ptr<spdlog::sinks::sink>> sinks );
+    static void                            logToLogger( spdlog::logger*  logger,
+                                                        Level            level,
+                                                        std::string_view message,
+                                                        std::string*     movableMessage,
+                                                        bool             bypassLoggerLevel );
+
+    struct AsyncLoggerWorker
+    {
+        std::weak_ptr<spdlog::details::thread_pool> threadPool;
+        std::weak_ptr<spdlog::logger>               logger;
+    };
+
+    /**
+     * Remove the retired workers no living async logger uses any more. Called with s_mutex held.
+     * The caller releases them after unlocking, which joins their threads.
+     */
+    static std::vector<std::shared_ptr<spdlog::details::thread_pool>> takeUnusedAsyncWorkers();
+
     static std::mutex s_mutex;
 
+    static std::vector<std::shared_ptr<spdlog::details::thread_pool>> s_asyncWorkers;
+    static std::vector<std::shared_ptr<spdlog::details::thread_pool>> s_retiredAsyncWorkers;
+    static OverflowPolicy                                             s_asyncOverflowPolicy;
+    static size_t                                                     s_nextAsyncWorker;
+    static std::map<std::string, AsyncLoggerWorker>                   s_asyncLoggerWorkers;
+
+    static std::map<WorkerThread, ThreadConfiguration> s_workerThreadConfigurations;
+    static uint64_t                                    s_flushTimer;
+
+    // Effective levels by logger name. The levels are updated in place and a table is only replaced when a name is
+    // added, so shouldLog reads them without locking. Replaced tables are kept, as readers may still be using them.
+    using EffectiveLevelTable = std::map<std::string, std::atomic<Level>*, std::less<>>;
+    static std::atomic<Level>& addEffectiveLevel( std::string_view loggerName, Level level );
+
+    static std::mutex                                        s_refreshLevelsMutex; ///< Serialises all updates
+    static std::deque<std::atomic<Level>>                    s_effectiveLevelSlots;
+    static std::vector<std::unique_ptr<EffectiveLevelTable>> s_effectiveLevelTables;
+    static std::atomic<const EffectiveLevelTable*>           s_effectiveLevelTable;
+    static std::atomic<Level>                                s_defaultEffectiveLevel;
+    static std::atomic<Level>                                s_lowestEffectiveLevel;
+
     static std::function<std::string( std::string )> s_functionNameReplacer;
 };
 
+/**
+ * Compile-time configuration of a log category used with CAFFA_LOG.
+ * Statements below the minimum level of their category are removed at compile time.
+ * Override the minimum level of a category with CAFFA_LOG_CATEGORY_MINIMUM_LEVEL.
+ */
+template <StringTools::FixedString Category>
+struct LogCategory
+{
+    static constexpr Logger::Level minimumLevel = static_cast<Logger::Level>( CAFFA_LOG_MINIMUM_LEVEL );
+};
+
+template <StringTools::FixedString Category>
+constexpr bool isLogCategoryEnabled( Logger::Level level )
+{
+    return level >= LogCategory<Category>::minimumLevel && level < Logger::Level::off;
+}
+
+/**
+ * Descriptor of a single log statement. Every CAFFA_* logging macro expansion owns a static instance which
+ * is added to a global list the first time the statement runs.
+ * Switching a call site on logs it regardless of the logger level, switching it off silences it.
+ * Checking the state costs a single relaxed load per statement.
+ */
+class LogCallSite
+{
+public:
+    enum class State : int
+    {
+        automatic, ///< Follow the level of the logger
+        on,
+        off
+    };
+
+    LogCallSite( const char* file, const char* function, int line, Logger::Level level );
+
+    State state() const noexcept { return m_state.load( std::memory_order_relaxed ); }
+    void  setState( State state ) noexcept { m_state.store( state, std::memory_order_relaxed ); }
+
+    const char*   file() const noexcept { return m_file; }
+    const char*   function() const noexcept { return m_function; }
+    int           line() const noexcept { return m_line; }
+    Logger::Level level() const noexcept { return m_level; }
+
+    /**
+     * All call sites that have run so far, most recent first
+     */
+    static std::vector<LogCallSite*> callSites();
+
+    /**
+     * Set the state of all call sites matching the patterns and return how many matched.
+     * File and function patterns are globs with * and ? which match everything when empty.
+     * The file pattern is tried against both the full path and the file name. A line of 0 matches any line.
+     * Only call sites that have already run are affected.
+     * I.e. LogCallSite::setState( "*cafLogger.cpp", "registerQueuedSink", 0, LogCallSite::State::on );
+     */
+    static size_t setState( const std::string& filePattern, const std::string& functionPattern, int line, State state );
+
+private:
+    const char*        m_file;
+    const char*        m_function;
+    int                m_line;
+    Logger::Level      m_level;
+    std::atomic<State> m_state;
+    LogCallSite*       m_next;
+
+    static std::atomic<LogCallSite*> s_firstCallSite;
+};
+
 } // namespace caffa
 
+/**
+ * Set the compile-time minimum level of a log category. Has to be visible before the category is first used,
+ * so it belongs in a header shared by all users of the category.
+ * I.e. CAFFA_LOG_CATEGORY_MINIMUM_LEVEL( "net.rx", caffa::Logger::Level::info );
+ */
+#define CAFFA_LOG_CATEGORY_MINIMUM_LEVEL( CATEGORY, LEVEL )         \
+    template <>                                                     \
+    struct caffa::LogCategory<CATEGORY>                             \
+    {                                                               \
+        static constexpr caffa::Logger::Level minimumLevel = LEVEL; \
+    }
+
 #define CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) \
     dynamic_cast<std::ostringstream&>( std::ostringstream().flush() << std::boolalpha << MESSAGE ).str()
 
@@ -102,55 +401,109 @@ private:
 
 #endif
 
+/**
+ * Register a static call site for the enclosing statement and log the message if the call site is switched on,
+ * or if it follows the logger and the effective level of the logger lets it through.
+ * The message is only built when it is going to be logged.
+ * Used by all the logging macros below. Pass an empty LOGGER_NAME for the default logger.
+ */
+#define CAFFA_LOG_CALL_SITE( LOGGER_NAME, LEVEL, MESSAGE_STRING )                             \
+    do                                                                                        \
+    {                                                                                         \
+        static caffa::LogCallSite caffa_call_site( __FILE__, __FUNCTION__, __LINE__, LEVEL ); \
+        const auto                caffa_call_site_state = caffa_call_site.state();            \
+        if ( caffa_call_site_state == caffa::LogCallSite::State::on ||                        \
+             ( caffa_call_site_state == caffa::LogCallSite::State::automatic &&               \
+               caffa::Logger::shouldLog( LOGGER_NAME, LEVEL ) ) )                             \
+        {                                                                                     \
+            caffa::Logger::log( LOGGER_NAME,                                                  \
+                                LEVEL,                                                        \
+                                MESSAGE_STRING,                                               \
+                                caffa_call_site_state == caffa::LogCallSite::State::on );     \
+        }                                                                                     \
+    } while ( false )
+
 #define CAFFA_CRITICAL_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::critical, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::critical, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 #define CAFFA_ERROR_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::err, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::err, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 #define CAFFA_WARNING_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::warn, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::warn, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 #define CAFFA_INFO_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::info, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::info, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 #define CAFFA_DEBUG_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::debug, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::debug, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 
 #ifndef NDEBUG
 #define CAFFA_TRACE_SINK( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::trace, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::trace, CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ) )
 #else
 #define CAFFA_TRACE_SINK( LOGGER_NAME, MESSAGE ) \
+    do                                           \
     {                                            \
-    }
+    } while ( false )
 #endif
 
 #define CAFFA_CRITICAL_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::critical, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::critical, CAFFA_GENERATE_MSG( MESSAGE ) )
 #define CAFFA_ERROR_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::err, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::err, CAFFA_GENERATE_MSG( MESSAGE ) )
 #define CAFFA_WARNING_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::warn, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::warn, CAFFA_GENERATE_MSG( MESSAGE ) )
 #define CAFFA_INFO_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::info, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::info, CAFFA_GENERATE_MSG( MESSAGE ) )
 #define CAFFA_DEBUG_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::debug, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::debug, CAFFA_GENERATE_MSG( MESSAGE ) )
 
 #ifndef NDEBUG
 #define CAFFA_TRACE_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
-    caffa::Logger::log( LOGGER_NAME, caffa::Logger::Level::trace, CAFFA_GENERATE_MSG( MESSAGE ) )
+    CAFFA_LOG_CALL_SITE( LOGGER_NAME, caffa::Logger::Level::trace, CAFFA_GENERATE_MSG( MESSAGE ) )
 #else
 #define CAFFA_TRACE_SINK_CODE_LINE( LOGGER_NAME, MESSAGE ) \
+    do                                                     \
     {                                                      \
-    }
+    } while ( false )
 #endif
 
-#define CAFFA_CRITICAL( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::critical, CAFFA_GENERATE_MSG( MESSAGE ) )
-#define CAFFA_ERROR( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::err, CAFFA_GENERATE_MSG( MESSAGE ) )
-#define CAFFA_WARNING( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::warn, CAFFA_GENERATE_MSG( MESSAGE ) )
-#define CAFFA_INFO( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::info, CAFFA_GENERATE_MSG( MESSAGE ) )
-#define CAFFA_DEBUG( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::debug, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_CRITICAL( MESSAGE ) \
+    CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::critical, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_ERROR( MESSAGE ) CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::err, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_WARNING( MESSAGE ) CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::warn, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_INFO( MESSAGE ) CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::info, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_DEBUG( MESSAGE ) CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::debug, CAFFA_GENERATE_MSG( MESSAGE ) )
 #ifndef NDEBUG
-#define CAFFA_TRACE( MESSAGE ) caffa::Logger::log( caffa::Logger::Level::trace, CAFFA_GENERATE_MSG( MESSAGE ) )
+#define CAFFA_TRACE( MESSAGE ) CAFFA_LOG_CALL_SITE( "", caffa::Logger::Level::trace, CAFFA_GENERATE_MSG( MESSAGE ) )
 #else
 #define CAFFA_TRACE( MESSAGE ) \
+    do                         \
     {                          \
-    }
+    } while ( false )
 #endif
+
+/**
+ * Log to a category logger. The category is a string literal that doubles as the logger name.
+ * The statement is compiled out entirely if LEVEL is below the compile-time minimum level of the category.
+ * The logger is resolved once per call site, so register it before the first statement runs.
+ * Like the other logging macros the statement is a LogCallSite that can be switched on or off at runtime.
+ * I.e. CAFFA_LOG( "net.rx", caffa::Logger::Level::debug, "Received " << bytes << " bytes" );
+ */
+#define CAFFA_LOG( CATEGORY, LEVEL, MESSAGE )                                                          \
+    do                                                                                                 \
+    {                                                                                                  \
+        if constexpr ( caffa::isLogCategoryEnabled<CATEGORY>( LEVEL ) )                                \
+        {                                                                                              \
+            static caffa::LogCallSite caffa_call_site( __FILE__, __FUNCTION__, __LINE__, LEVEL );      \
+            static const auto caffa_category_logger = caffa::Logger::findLogger( CATEGORY );           \
+            static const auto& caffa_category_level = caffa::Logger::effectiveLevelOf( CATEGORY );     \
+            const auto caffa_call_site_state = caffa_call_site.state();                                \
+            if ( caffa_call_site_state == caffa::LogCallSite::State::on ||                             \
+                 ( caffa_call_site_state == caffa::LogCallSite::State::automatic &&                    \
+                   caffa::Logger::shouldLog( caffa_category_level, LEVEL ) ) )                         \
+            {                                                                                          \
+                caffa::Logger::log( caffa_category_logger,                                             \
+                                    LEVEL,                                                             \
+                                    CAFFA_GENERATE_SIMPLE_MSG( MESSAGE ),                              \
+                                    caffa_call_site_state == caffa::LogCallSite::State::on );          \
+            }                                                                                          \
+        }                                                                                              \
+    } while ( false )
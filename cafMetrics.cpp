@@ -0,0 +1,320 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafMetrics.h"
+
+#include "cafLogger.h"
+#include "cafTimerService.h"
+
+#include "spdlog/fmt/fmt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace caffa;
+
+namespace
+{
+struct Registry
+{
+    std::mutex                                                           mutex;
+    std::map<std::string, std::unique_ptr<MetricCounter>, std::less<>>   counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>, std::less<>>     gauges;
+    std::map<std::string, std::unique_ptr<MetricHistogram>, std::less<>> histograms;
+    uint64_t                                                             writer = 0u;
+};
+
+Registry& registry()
+{
+    // Never destroyed, as metrics may still be updated from static destructors and detached threads
+    static auto* registry = new Registry;
+    return *registry;
+}
+
+// Explicit ASCII ranges, since the character classes of the C library depend on the locale
+bool isValidName( const std::string& name )
+{
+    auto validFirst = []( char c )
+    { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '_' || c == ':'; };
+    auto valid = [&validFirst]( char c ) { return validFirst( c ) || ( c >= '0' && c <= '9' ); };
+    return !name.empty() && validFirst( name.front() ) && std::all_of( name.begin() + 1, name.end(), valid );
+}
+
+template <typename Metric, typename Map, typename... OtherMaps>
+Metric& getOrCreate( Map& metrics, const std::string& name, const std::string& help, const OtherMaps&... otherMaps )
+{
+    std::scoped_lock lock( registry().mutex );
+    if ( auto it = metrics.find( name ); it != metrics.end() )
+    {
+        return *it->second;
+    }
+
+    if ( !isValidName( name ) )
+    {
+        throw std::invalid_argument( "Invalid metric name '" + name + "'" );
+    }
+    if ( ( otherMaps.contains( name ) || ... ) )
+    {
+        throw std::invalid_argument( "Metric '" + name + "' is already registered with a different type" );
+    }
+    return *metrics.emplace( name, std::make_unique<Metric>( name, help ) ).first->second;
+}
+
+// Prometheus spells the special values NaN, +Inf and -Inf, where fmt writes nan, inf and -inf
+std::string sampleValue( double value )
+{
+    if ( std::isnan( value ) ) return "NaN";
+    if ( std::isinf( value ) ) return value > 0.0 ? "+Inf" : "-Inf";
+    return fmt::format( "{}", value );
+}
+
+void appendHeader( std::string& text, const std::string& name, const std::string& help, const char* type )
+{
+    if ( !help.empty() )
+    {
+        text += "# HELP " + name + " ";
+        for ( char c : help )
+        {
+            if ( c == '\\' )
+                text += "\\\\";
+            else if ( c == '\n' )
+                text += "\\n";
+            else
+                text += c;
+        }
+        text += '\n';
+    }
+    text += fmt::format( "# TYPE {} {}\n", name, type );
+}
+
+} // namespace
+
+MetricCounter::MetricCounter( const std::string& name, const std::string& help )
+    : m_name( name )
+    , m_help( help )
+{
+    size_t shardCount = std::bit_ceil( std::clamp( std::thread::hardware_concurrency(), 1u, 64u ) );
+    m_shardMask       = shardCount - 1u;
+    m_shards          = std::make_unique<Shard[]>( shardCount );
+}
+
+uint64_t MetricCounter::value() const noexcept
+{
+    uint64_t value = 0u;
+    for ( size_t i = 0; i <= m_shardMask; ++i )
+    {
+        value += m_shards[i].value.load( std::memory_order_relaxed );
+    }
+    return value;
+}
+
+size_t MetricCounter::currentCpu() noexcept
+{
+#ifdef __linux__
+    if ( int cpu = sched_getcpu(); cpu >= 0 )
+    {
+        return static_cast<size_t>( cpu );
+    }
+#endif
+    return std::hash<std::thread::id>{}( std::this_thread::get_id() );
+}
+
+MetricGauge::MetricGauge( const std::string& name, const std::string& help )
+    : m_name( name )
+    , m_help( help )
+{
+}
+
+MetricHistogram::MetricHistogram( const std::string& name, const std::string& help )
+    : m_name( name )
+    , m_help( help )
+{
+}
+
+uint64_t MetricHistogram::count() const noexcept
+{
+    uint64_t count = 0u;
+    for ( const auto& bucket : m_buckets )
+    {
+        count += bucket.load( std::memory_order_relaxed );
+    }
+    return count;
+}
+
+uint64_t MetricHistogram::quantile( double quantile ) const noexcept
+{
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t                           total = 0u;
+    for ( size_t i = 0; i < BUCKET_COUNT; ++i )
+    {
+        counts[i] = m_buckets[i].load( std::memory_order_relaxed );
+        total += counts[i];
+    }
+    if ( total == 0u ) return 0u;
+
+    auto     rank       = static_cast<uint64_t>( std::clamp( quantile, 0.0, 1.0 ) * static_cast<double>( total - 1u ) );
+    uint64_t cumulative = 0u;
+    for ( size_t i = 0; i < BUCKET_COUNT; ++i )
+    {
+        cumulative += counts[i];
+        if ( cumulative > rank ) return bucketUpperBound( i );
+    }
+    return bucketUpperBound( BUCKET_COUNT - 1u );
+}
+
+uint64_t MetricHistogram::bucketUpperBound( size_t index ) noexcept
+{
+    if ( index < SUB_BUCKET_COUNT ) return index;
+
+    auto shift = static_cast<unsigned>( index / SUB_BUCKET_COUNT - 1u );
+    auto lower = static_cast<uint64_t>( index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT ) << shift;
+    return lower + ( ( uint64_t( 1u ) << shift ) - 1u );
+}
+
+MetricCounter& Metrics::counter( const std::string& name, const std::string& help )
+{
+    auto& metrics = registry();
+    return getOrCreate<MetricCounter>( metrics.counters, name, help, metrics.gauges, metrics.histograms );
+}
+
+MetricGauge& Metrics::gauge( const std::string& name, const std::string& help )
+{
+    auto& metrics = registry();
+    return getOrCreate<MetricGauge>( metrics.gauges, name, help, metrics.counters, metrics.histograms );
+}
+
+MetricHistogram& Metrics::histogram( const std::string& name, const std::string& help )
+{
+    auto& metrics = registry();
+    return getOrCreate<MetricHistogram>( metrics.histograms, name, help, metrics.counters, metrics.gauges );
+}
+
+std::string Metrics::prometheusText()
+{
+    auto& metrics = registry();
+
+    std::map<std::string_view, std::string> texts;
+    {
+        std::scoped_lock lock( metrics.mutex );
+        for ( const auto& [name, counter] : metrics.counters )
+        {
+            auto& text = texts[name];
+            appendHeader( text, name, counter->help(), "counter" );
+            text += fmt::format( "{} {}\n", name, counter->value() );
+        }
+        for ( const auto& [name, gauge] : metrics.gauges )
+        {
+            auto& text = texts[name];
+            appendHeader( text, name, gauge->help(), "gauge" );
+            text += fmt::format( "{} {}\n", name, sampleValue( gauge->value() ) );
+        }
+        for ( const auto& [name, histogram] : metrics.histograms )
+        {
+            auto& text = texts[name];
+            appendHeader( text, name, histogram->help(), "histogram" );
+
+            uint64_t cumulative = 0u;
+            for ( size_t i = 0; i < MetricHistogram::BUCKET_COUNT; ++i )
+            {
+                if ( auto count = histogram->bucketCount( i ); count > 0u )
+                {
+                    cumulative += count;
+                    text += fmt::format( "{}_bucket{{le=\"{}\"}} {}\n",
+                                         name,
+                                         MetricHistogram::bucketUpperBound( i ),
+                                         cumulative );
+                }
+            }
+            text += fmt::format( "{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative );
+            text += fmt::format( "{}_sum {}\n", name, histogram->sum() );
+            text += fmt::format( "{}_count {}\n", name, cumulative );
+        }
+    }
+
+    std::string result;
+    for ( const auto& [name, text] : texts )
+    {
+        result += text;
+    }
+    return result;
+}
+
+bool Metrics::writeSnapshot( const std::string& file )
+{
+    auto temporaryFile = file + ".tmp";
+    {
+        std::ofstream stream( temporaryFile, std::ios::out | std::ios::trunc );
+        stream << prometheusText();
+        if ( !stream ) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename( temporaryFile, file, error );
+    return !error;
+}
+
+void Metrics::startPeriodicWrite( const std::string& file, std::chrono::milliseconds interval )
+{
+    auto timer = TimerService::scheduleRepeating( interval,
+                                                  [file]()
+                                                  {
+                                                      if ( !writeSnapshot( file ) )
+                                                      {
+                                                          CAFFA_WARNING( "Could not write metrics to " << file );
+                                                      }
+                                                  } );
+
+    auto&    metrics       = registry();
+    uint64_t previousTimer = 0u;
+    {
+        std::scoped_lock lock( metrics.mutex );
+        previousTimer = std::exchange( metrics.writer, timer );
+    }
+    if ( previousTimer )
+    {
+        TimerService::cancel( previousTimer );
+    }
+}
+
+void Metrics::stopPeriodicWrite()
+{
+    auto&    metrics       = registry();
+    uint64_t previousTimer = 0u;
+    {
+        std::scoped_lock lock( metrics.mutex );
+        previousTimer = std::exchange( metrics.writer, 0u );
+    }
+    if ( previousTimer )
+    {
+        TimerService::cancel( previousTimer );
+    }
+}
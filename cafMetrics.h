@@ -0,0 +1,199 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace caffa
+{
+/**
+ * Monotonic counter. Increments go to one of a set of cache line sized shards picked by the CPU the thread runs on,
+ * so threads on different cores do not contend for the same line. Reading sums the shards.
+ */
+class MetricCounter
+{
+public:
+    MetricCounter( const std::string& name, const std::string& help );
+
+    void increment( uint64_t amount = 1u ) noexcept
+    {
+        m_shards[shardIndex() & m_shardMask].value.fetch_add( amount, std::memory_order_relaxed );
+    }
+
+    uint64_t           value() const noexcept;
+    const std::string& name() const noexcept { return m_name; }
+    const std::string& help() const noexcept { return m_help; }
+
+private:
+    struct alignas( 64 ) Shard
+    {
+        std::atomic<uint64_t> value = 0u;
+    };
+
+    /**
+     * The CPU of the thread is looked up once in a while rather than for every increment.
+     * A thread that has moved in between still counts correctly, only on a shared line.
+     * The thread locals are constant initialised so no guard is checked on the way.
+     */
+    static size_t shardIndex() noexcept
+    {
+        thread_local uint32_t t_increments = 0u;
+        thread_local size_t   t_shard      = 0u;
+        if ( ( t_increments++ & 1023u ) == 0u )
+        {
+            t_shard = currentCpu();
+        }
+        return t_shard;
+    }
+    static size_t currentCpu() noexcept;
+
+    std::string              m_name;
+    std::string              m_help;
+    size_t                   m_shardMask;
+    std::unique_ptr<Shard[]> m_shards;
+};
+
+/**
+ * Value that can go up and down.
+ */
+class MetricGauge
+{
+public:
+    MetricGauge( const std::string& name, const std::string& help );
+
+    void set( double value ) noexcept { m_value.store( value, std::memory_order_relaxed ); }
+    void add( double amount ) noexcept { m_value.fetch_add( amount, std::memory_order_relaxed ); }
+    void subtract( double amount ) noexcept { m_value.fetch_sub( amount, std::memory_order_relaxed ); }
+
+    double             value() const noexcept { return m_value.load( std::memory_order_relaxed ); }
+    const std::string& name() const noexcept { return m_name; }
+    const std::string& help() const noexcept { return m_help; }
+
+private:
+    std::string         m_name;
+    std::string         m_help;
+    std::atomic<double> m_value = 0.0;
+};
+
+/**
+ * Distribution of non-negative integer values such as latencies in nanoseconds or sizes in bytes.
+ *
+ * Buckets are log-linear like in HdrHistogram: each power of two is split into 16 equally wide buckets,
+ * so a value is known to within 1/16 (6.25 %) over the whole 64 bit range. Recording is a couple of relaxed
+ * atomic additions with no locks.
+ */
+class MetricHistogram
+{
+public:
+    static constexpr unsigned SUB_BUCKET_BITS  = 4u;
+    static constexpr size_t   SUB_BUCKET_COUNT = size_t( 1u ) << SUB_BUCKET_BITS;
+    static constexpr size_t   BUCKET_COUNT     = ( 64u - SUB_BUCKET_BITS + 1u ) * SUB_BUCKET_COUNT;
+
+    MetricHistogram( const std::string& name, const std::string& help );
+
+    void record( uint64_t value ) noexcept
+    {
+        m_buckets[bucketIndex( value )].fetch_add( 1u, std::memory_order_relaxed );
+        m_sum.fetch_add( value, std::memory_order_relaxed );
+    }
+
+    uint64_t count() const noexcept;
+    uint64_t sum() const noexcept { return m_sum.load( std::memory_order_relaxed ); }
+    uint64_t bucketCount( size_t index ) const noexcept { return m_buckets[index].load( std::memory_order_relaxed ); }
+
+    /**
+     * The value below which the given fraction of the recorded values lie, to within the bucket resolution.
+     * @param quantile between 0 and 1
+     * @return the upper bound of the bucket the quantile falls in, or 0 if nothing has been recorded
+     */
+    uint64_t quantile( double quantile ) const noexcept;
+
+    const std::string& name() const noexcept { return m_name; }
+    const std::string& help() const noexcept { return m_help; }
+
+    static size_t bucketIndex( uint64_t value ) noexcept
+    {
+        if ( value < SUB_BUCKET_COUNT ) return static_cast<size_t>( value );
+
+        // Bit width is at least SUB_BUCKET_BITS + 1 here, so the shift keeps the top SUB_BUCKET_BITS + 1 bits
+        unsigned shift = static_cast<unsigned>( std::bit_width( value ) ) - SUB_BUCKET_BITS - 1u;
+        return ( shift + 1u ) * SUB_BUCKET_COUNT + static_cast<size_t>( ( value >> shift ) - SUB_BUCKET_COUNT );
+    }
+
+    /**
+     * Largest value that falls in the bucket
+     */
+    static uint64_t bucketUpperBound( size_t index ) noexcept;
+
+private:
+    std::string                                     m_name;
+    std::string                                     m_help;
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t>                           m_sum = 0u;
+};
+
+/**
+ * Process wide registry of metrics, exported in the Prometheus text format.
+ *
+ * Metrics are created on first use and live until the end of the program, so the references handed out can be kept.
+ * Look them up once and keep the reference to keep the registry lookup out of inner loops. I.e.
+ *   static auto& framesRead = caffa::Metrics::counter( "caffa_frames_read_total", "Frames read" );
+ *   framesRead.increment();
+ */
+class Metrics
+{
+public:
+    /**
+     * Get or create a metric. Names have to be valid Prometheus metric names.
+     * @throws std::invalid_argument if the name is invalid or taken by a metric of a different type
+     */
+    static MetricCounter&   counter( const std::string& name, const std::string& help = "" );
+    static MetricGauge&     gauge( const std::string& name, const std::string& help = "" );
+    static MetricHistogram& histogram( const std::string& name, const std::string& help = "" );
+
+    /**
+     * Snapshot of all metrics in the Prometheus text exposition format, sorted by name.
+     * Histograms only list the buckets that have values, which Prometheus accepts as the buckets are cumulative.
+     */
+    static std::string prometheusText();
+
+    /**
+     * Write the snapshot to a file at regular intervals on the timer service thread. The file is replaced atomically,
+     * so it can be picked up by the node exporter text file collector.
+     */
+    static void startPeriodicWrite( const std::string& file, std::chrono::milliseconds interval );
+    static void stopPeriodicWrite();
+
+    /**
+     * Write the snapshot to a file once, replacing it atomically
+     * @return false if the file could not be written
+     */
+    static bool writeSnapshot( const std::string& file );
+};
+
+} // namespace caffa
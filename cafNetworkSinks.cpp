@@ -0,0 +1,365 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafNetworkSinks.h"
+
+#include "cafProbes.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace caffa;
+
+namespace
+{
+sockaddr_storage resolve( const std::string& host, uint16_t port, int socketType, socklen_t* addressLength )
+{
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = socketType;
+
+    addrinfo* addresses = nullptr;
+    if ( int result = ::getaddrinfo( host.c_str(), std::to_string( port ).c_str(), &hints, &addresses ); result != 0 )
+    {
+        spdlog::throw_spdlog_ex( "Could not resolve " + host + ": " + ::gai_strerror( result ) );
+    }
+
+    sockaddr_storage address{};
+    std::memcpy( &address, addresses->ai_addr, addresses->ai_addrlen );
+    *addressLength = addresses->ai_addrlen;
+    ::freeaddrinfo( addresses );
+    return address;
+}
+
+size_t frameLength( const char* header )
+{
+    uint32_t length = 0u;
+    std::memcpy( &length, header, 4u );
+    return ntohl( length );
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+} // namespace
+
+BatchedUdpSink::BatchedUdpSink( const std::string& host, uint16_t port, size_t batchSize, size_t maxDatagramSize )
+    : m_socket( -1 )
+    , m_batchSize( std::max( batchSize, size_t( 1u ) ) )
+    , m_maxDatagramSize( maxDatagramSize )
+{
+    socklen_t addressLength = 0;
+    auto      address       = resolve( host, port, SOCK_DGRAM, &addressLength );
+
+    m_socket = ::socket( address.ss_family, SOCK_DGRAM, 0 );
+    if ( m_socket < 0 )
+    {
+        spdlog::throw_spdlog_ex( "Could not create UDP socket", errno );
+    }
+    // Connected so the batch needs no per-message destination
+    if ( ::connect( m_socket, reinterpret_cast<const sockaddr*>( &address ), addressLength ) != 0 )
+    {
+        int error = errno;
+        ::close( m_socket );
+        spdlog::throw_spdlog_ex( "Could not connect UDP socket to " + host, error );
+    }
+    m_recordEnds.reserve( m_batchSize );
+#ifdef __linux__
+    m_iovecs.resize( m_batchSize );
+    m_messages.resize( m_batchSize );
+    for ( size_t i = 0; i < m_batchSize; ++i )
+    {
+        m_messages[i].msg_hdr.msg_iov    = &m_iovecs[i];
+        m_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+}
+
+BatchedUdpSink::~BatchedUdpSink()
+{
+    std::scoped_lock lock( mutex_ );
+    sendBatch();
+    ::close( m_socket );
+}
+
+size_t BatchedUdpSink::droppedCount() const
+{
+    return m_dropped.load( std::memory_order_relaxed );
+}
+
+void BatchedUdpSink::sink_it_( const spdlog::details::log_msg& msg )
+{
+    m_formatted.clear();
+    formatter_->format( msg, m_formatted );
+
+    size_t length = std::min( m_formatted.size(), m_maxDatagramSize );
+    m_batch.insert( m_batch.end(), m_formatted.data(), m_formatted.data() + length );
+    m_recordEnds.push_back( m_batch.size() );
+
+    if ( m_recordEnds.size() >= m_batchSize )
+    {
+        sendBatch();
+    }
+}
+
+void BatchedUdpSink::flush_()
+{
+    sendBatch();
+}
+
+void BatchedUdpSink::sendBatch()
+{
+    if ( m_recordEnds.empty() ) return;
+
+#ifdef __linux__
+    const size_t count = m_recordEnds.size();
+    size_t       begin = 0u;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        m_iovecs[i].iov_base = m_batch.data() + begin;
+        m_iovecs[i].iov_len  = m_recordEnds[i] - begin;
+        begin                = m_recordEnds[i];
+    }
+
+    size_t sent = 0u;
+    while ( sent < count )
+    {
+        int result = ::sendmmsg( m_socket, m_messages.data() + sent, static_cast<unsigned>( count - sent ), 0 );
+        if ( result < 0 )
+        {
+            if ( errno == EINTR ) continue;
+            // Datagrams are best effort, so the rest of the batch is given up rather than retried
+            m_dropped.fetch_add( count - sent, std::memory_order_relaxed );
+            CAFFA_PROBE( message_drop, -1, count - sent );
+            break;
+        }
+        sent += static_cast<size_t>( result );
+    }
+#else
+    size_t begin = 0u;
+    for ( size_t end : m_recordEnds )
+    {
+        if ( ::send( m_socket, m_batch.data() + begin, end - begin, 0 ) < 0 )
+        {
+            m_dropped.fetch_add( 1u, std::memory_order_relaxed );
+            CAFFA_PROBE( message_drop, -1, static_cast<size_t>( 1u ) );
+        }
+        begin = end;
+    }
+#endif
+    m_batch.clear();
+    m_recordEnds.clear();
+}
+
+FramedTcpSink::FramedTcpSink( const std::string&        host,
+                              uint16_t                  port,
+                              size_t                    bufferSize,
+                              size_t                    maxBufferSize,
+                              std::chrono::milliseconds reconnectInterval )
+    : m_addressLength( 0 )
+    , m_bufferSize( bufferSize )
+    , m_maxBufferSize( std::max( maxBufferSize, bufferSize ) )
+    , m_reconnectInterval( reconnectInterval )
+{
+    m_address = resolve( host, port, SOCK_STREAM, &m_addressLength );
+    m_buffer.reserve( m_bufferSize + 4096u );
+    ensureConnected();
+}
+
+FramedTcpSink::~FramedTcpSink()
+{
+    std::scoped_lock lock( mutex_ );
+    if ( m_state == ConnectionState::connected )
+    {
+        // A last attempt on the way out. Give the socket a moment to drain, but never hang on a stuck receiver.
+        int flags = ::fcntl( m_socket, F_GETFL, 0 );
+        ::fcntl( m_socket, F_SETFL, flags & ~O_NONBLOCK );
+        timeval timeout{ 1, 0 };
+        ::setsockopt( m_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+        sendBuffered();
+    }
+    disconnect();
+}
+
+bool FramedTcpSink::connected() const
+{
+    return m_state == ConnectionState::connected;
+}
+
+size_t FramedTcpSink::droppedCount() const
+{
+    return m_dropped.load( std::memory_order_relaxed );
+}
+
+void FramedTcpSink::sink_it_( const spdlog::details::log_msg& msg )
+{
+    m_formatted.clear();
+    formatter_->format( msg, m_formatted );
+
+    if ( m_buffer.size() + 4u + m_formatted.size() > m_maxBufferSize )
+    {
+        m_dropped.fetch_add( 1u, std::memory_order_relaxed );
+        CAFFA_PROBE( message_drop, static_cast<int>( msg.level ), static_cast<size_t>( 1u ) );
+    }
+    else
+    {
+        uint32_t length = htonl( static_cast<uint32_t>( m_formatted.size() ) );
+        auto     header = reinterpret_cast<const char*>( &length );
+        m_buffer.insert( m_buffer.end(), header, header + 4u );
+        m_buffer.insert( m_buffer.end(), m_formatted.data(), m_formatted.data() + m_formatted.size() );
+    }
+
+    if ( m_buffer.size() - m_sent >= m_bufferSize )
+    {
+        sendBuffered();
+    }
+}
+
+void FramedTcpSink::flush_()
+{
+    sendBuffered();
+}
+
+bool FramedTcpSink::ensureConnected()
+{
+    if ( m_state == ConnectionState::connecting )
+    {
+        pollfd descriptor{ m_socket, POLLOUT, 0 };
+        if ( ::poll( &descriptor, 1, 0 ) == 0 ) return false;
+
+        int       error  = 0;
+        socklen_t length = sizeof( error );
+        ::getsockopt( m_socket, SOL_SOCKET, SO_ERROR, &error, &length );
+        if ( error != 0 )
+        {
+            disconnect();
+            return false;
+        }
+        m_state = ConnectionState::connected;
+    }
+    if ( m_state == ConnectionState::connected ) return true;
+
+    auto now = std::chrono::steady_clock::now();
+    if ( now < m_nextConnectAttempt ) return false;
+    m_nextConnectAttempt = now + m_reconnectInterval;
+
+    m_socket = ::socket( m_address.ss_family, SOCK_STREAM, 0 );
+    if ( m_socket < 0 ) return false;
+
+    ::fcntl( m_socket, F_SETFL, ::fcntl( m_socket, F_GETFL, 0 ) | O_NONBLOCK );
+    ::fcntl( m_socket, F_SETFD, FD_CLOEXEC );
+    int noDelay = 1;
+    ::setsockopt( m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof( noDelay ) );
+#ifdef SO_NOSIGPIPE
+    int noSigPipe = 1;
+    ::setsockopt( m_socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof( noSigPipe ) );
+#endif
+
+    if ( ::connect( m_socket, reinterpret_cast<const sockaddr*>( &m_address ), m_addressLength ) == 0 )
+    {
+        m_state = ConnectionState::connected;
+        return true;
+    }
+    if ( errno == EINPROGRESS )
+    {
+        m_state = ConnectionState::connecting;
+        return false;
+    }
+    disconnect();
+    return false;
+}
+
+void FramedTcpSink::sendBuffered()
+{
+    if ( m_sent == m_buffer.size() || !ensureConnected() ) return;
+
+    while ( m_sent < m_buffer.size() )
+    {
+        auto result = ::send( m_socket, m_buffer.data() + m_sent, m_buffer.size() - m_sent, SendFlags );
+        if ( result < 0 )
+        {
+            if ( errno == EINTR ) continue;
+            if ( errno != EAGAIN && errno != EWOULDBLOCK )
+            {
+                disconnect();
+            }
+            break;
+        }
+        m_sent += static_cast<size_t>( result );
+    }
+
+    if ( m_sent == m_buffer.size() )
+    {
+        m_buffer.clear();
+        m_sent = 0u;
+    }
+    else if ( m_sent >= m_bufferSize )
+    {
+        // Drop the records already sent so the buffer does not creep along behind a slow receiver.
+        // The buffer has to keep starting on a frame.
+        size_t frameStart = 0u;
+        while ( true )
+        {
+            size_t frameEnd = frameStart + 4u + frameLength( m_buffer.data() + frameStart );
+            if ( frameEnd > m_sent ) break;
+            frameStart = frameEnd;
+        }
+        m_buffer.erase( m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>( frameStart ) );
+        m_sent -= frameStart;
+    }
+}
+
+void FramedTcpSink::disconnect()
+{
+    if ( m_socket >= 0 )
+    {
+        ::close( m_socket );
+        m_socket = -1;
+    }
+    m_state = ConnectionState::disconnected;
+
+    if ( m_sent == 0u ) return;
+
+    // Skip the rest of a partly sent record, the next connection has to start on a frame
+    size_t frameEnd = 0u;
+    while ( frameEnd < m_sent )
+    {
+        frameEnd += 4u + frameLength( m_buffer.data() + frameEnd );
+    }
+    if ( frameEnd > m_sent )
+    {
+        m_dropped.fetch_add( 1u, std::memory_order_relaxed );
+        CAFFA_PROBE( message_drop, -1, static_cast<size_t>( 1u ) );
+    }
+    m_buffer.erase( m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>( frameEnd ) );
+    m_sent = 0u;
+}
@@ -0,0 +1,145 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "spdlog/sinks/base_sink.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * Sends each formatted record as a UDP datagram, in batches of up to batchSize records per sendmmsg call.
+ * Records are held until the batch is full or the sink is flushed, so set a flush level or flush interval
+ * on the logger to bound the delay.
+ * Register with Logger::registerCustomSink. Not available on Windows.
+ */
+class BatchedUdpSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    /**
+     * @param batchSize The number of records sent per sendmmsg call
+     * @param maxDatagramSize Records longer than this are cut off at this size, including their line ending,
+     *                        rather than split across datagrams or dropped
+     */
+    BatchedUdpSink( const std::string& host, uint16_t port, size_t batchSize = 64u, size_t maxDatagramSize = 65507u );
+    ~BatchedUdpSink() override;
+
+    BatchedUdpSink( const BatchedUdpSink& )            = delete;
+    BatchedUdpSink& operator=( const BatchedUdpSink& ) = delete;
+
+    /**
+     * Number of records that could not be sent
+     */
+    size_t droppedCount() const;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& msg ) override;
+    void flush_() override;
+
+private:
+    void sendBatch();
+
+    int    m_socket;
+    size_t m_batchSize;
+    size_t m_maxDatagramSize;
+
+    spdlog::memory_buf_t m_formatted;
+    std::vector<char>    m_batch;
+    std::vector<size_t>  m_recordEnds;
+#ifdef __linux__
+    // One per record of a batch, set up once so sending needs no allocations
+    std::vector<iovec>   m_iovecs;
+    std::vector<mmsghdr> m_messages;
+#endif
+    std::atomic<size_t>  m_dropped = 0u;
+};
+
+/**
+ * Sends formatted records over TCP, each framed by a 32-bit big-endian length, coalescing records into writes
+ * of about bufferSize bytes. The socket is non-blocking and so is reconnecting: while the receiver is
+ * unreachable, records are kept up to maxBufferSize bytes and new records are dropped beyond that.
+ * A connection attempt is made at most once per reconnectInterval. A record cut off by a lost connection
+ * is dropped so the receiver always sees whole frames.
+ * Register with Logger::registerCustomSink. Not available on Windows.
+ */
+class FramedTcpSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    FramedTcpSink( const std::string&        host,
+                   uint16_t                  port,
+                   size_t                    bufferSize        = 64u * 1024u,
+                   size_t                    maxBufferSize     = 16u * 1024u * 1024u,
+                   std::chrono::milliseconds reconnectInterval = std::chrono::milliseconds( 1000 ) );
+    ~FramedTcpSink() override;
+
+    FramedTcpSink( const FramedTcpSink& )            = delete;
+    FramedTcpSink& operator=( const FramedTcpSink& ) = delete;
+
+    bool connected() const;
+
+    /**
+     * Number of records dropped because the buffer was full or the connection was lost mid-record
+     */
+    size_t droppedCount() const;
+
+protected:
+    void sink_it_( const spdlog::details::log_msg& msg ) override;
+    void flush_() override;
+
+private:
+    enum class ConnectionState
+    {
+        disconnected,
+        connecting,
+        connected
+    };
+
+    bool ensureConnected();
+    void sendBuffered();
+    void disconnect();
+
+    sockaddr_storage          m_address;
+    socklen_t                 m_addressLength;
+    size_t                    m_bufferSize;
+    size_t                    m_maxBufferSize;
+    std::chrono::milliseconds m_reconnectInterval;
+
+    int                                   m_socket = -1;
+    std::atomic<ConnectionState>          m_state  = ConnectionState::disconnected;
+    std::chrono::steady_clock::time_point m_nextConnectAttempt;
+
+    spdlog::memory_buf_t m_formatted;
+    std::vector<char>    m_buffer;
+    size_t               m_sent    = 0u;
+    std::atomic<size_t>  m_dropped = 0u;
+};
+
+} // namespace caffa
@@ -17,8 +17,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <compare> // for compare_three_way
+#include <functional> // for hash, compare_three_way
 #include <iosfwd> // for ostream
-#include <system_error> // for hash
 #include <type_traits> // for enable_if_t, is_convertible, is_assignable
 
 //
@@ -134,6 +135,17 @@ namespace details
 #pragma clang diagnostic pop
 #endif
 
+//
+// CAFFA_NOT_NULL_CHECK_ACCESS
+//
+// not_null checks for null when it is constructed or assigned. Since it cannot become null after that,
+// the accessors by default only tell the optimizer the pointer is non-null, so they compile to plain loads.
+// Define CAFFA_NOT_NULL_CHECK_ACCESS to 1 to check on every access as well.
+//
+#ifndef CAFFA_NOT_NULL_CHECK_ACCESS
+#define CAFFA_NOT_NULL_CHECK_ACCESS 0
+#endif
+
 namespace caffa
 {
 namespace details
@@ -143,6 +155,11 @@ namespace details
     {
     };
 
+    template <typename T>
+    struct is_not_null : std::false_type
+    {
+    };
+
     template <typename T>
     struct is_comparable_to_nullptr<T, std::enable_if_t<std::is_convertible<decltype( std::declval<T>() != nullptr ), bool>::value>>
         : std::true_type
@@ -194,7 +211,11 @@ public:
     not_null& operator=( const not_null& other ) = default;
     constexpr std::conditional_t<std::is_copy_constructible<T>::value, T, const T&> get() const
     {
+#if CAFFA_NOT_NULL_CHECK_ACCESS
         Ensures( ptr_ != nullptr );
+#else
+        CAFFA_ASSUME( ptr_ != nullptr );
+#endif
         return ptr_;
     }
 
@@ -219,6 +240,14 @@ private:
     T ptr_;
 };
 
+namespace details
+{
+    template <typename T>
+    struct is_not_null<not_null<T>> : std::true_type
+    {
+    };
+} // namespace details
+
 template <class T>
 auto make_not_null( T&& t ) noexcept
 {
@@ -239,39 +268,28 @@ auto operator==( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noex
     return lhs.get() == rhs.get();
 }
 
+// != and the reversed argument orders are rewritten from these by the compiler
 template <class T, class U>
-auto operator!=( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noexcept( lhs.get() != rhs.get() ) )
-    -> decltype( lhs.get() != rhs.get() )
+    requires std::three_way_comparable_with<T, U>
+auto operator<=>( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept
 {
-    return lhs.get() != rhs.get();
+    return std::compare_three_way{}( lhs.get(), rhs.get() );
 }
 
+// Heterogeneous comparison with plain and smart pointers, i.e. not_null<int*> == int*
 template <class T, class U>
-auto operator<( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noexcept( lhs.get() < rhs.get() ) )
-    -> decltype( lhs.get() < rhs.get() )
+    requires( !details::is_not_null<U>::value )
+auto operator==( const not_null<T>& lhs, const U& rhs ) noexcept( noexcept( lhs.get() == rhs ) )
+    -> decltype( lhs.get() == rhs )
 {
-    return lhs.get() < rhs.get();
+    return lhs.get() == rhs;
 }
 
 template <class T, class U>
-auto operator<=( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noexcept( lhs.get() <= rhs.get() ) )
-    -> decltype( lhs.get() <= rhs.get() )
+    requires( !details::is_not_null<U>::value && std::three_way_comparable_with<T, U> )
+auto operator<=>( const not_null<T>& lhs, const U& rhs ) noexcept
 {
-    return lhs.get() <= rhs.get();
-}
-
-template <class T, class U>
-auto operator>( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noexcept( lhs.get() > rhs.get() ) )
-    -> decltype( lhs.get() > rhs.get() )
-{
-    return lhs.get() > rhs.get();
-}
-
-template <class T, class U>
-auto operator>=( const not_null<T>& lhs, const not_null<U>& rhs ) noexcept( noexcept( lhs.get() >= rhs.get() ) )
-    -> decltype( lhs.get() >= rhs.get() )
-{
-    return lhs.get() >= rhs.get();
+    return std::compare_three_way{}( lhs.get(), rhs );
 }
 
 // more unwanted operators
@@ -286,12 +304,28 @@ not_null<T> operator+( std::ptrdiff_t, const not_null<T>& ) = delete;
 
 } // namespace caffa
 
+namespace caffa
+{
+//
+// Transparent hash, so hash containers of not_null can be searched with the underlying pointer without wrapping it:
+//   std::unordered_set<not_null<Object*>, not_null_hash<Object*>, std::equal_to<>> objects;
+//   objects.find( rawPointer );
+//
+template <class T>
+struct not_null_hash
+{
+    using is_transparent = void;
+
+    std::size_t operator()( const not_null<T>& value ) const noexcept { return std::hash<T>{}( value.get() ); }
+    std::size_t operator()( const T& value ) const noexcept { return std::hash<T>{}( value ); }
+};
+} // namespace caffa
+
 namespace std
 {
 template <class T>
-struct hash<caffa::not_null<T>>
+struct hash<caffa::not_null<T>> : caffa::not_null_hash<T>
 {
-    std::size_t operator()( const caffa::not_null<T>& value ) const { return hash<T>{}( value.get() ); }
 };
 
 } // namespace std
\ No newline at end of file
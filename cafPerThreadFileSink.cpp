@@ -0,0 +1,303 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafPerThreadFileSink.h"
+
+#include "spdlog/details/file_helper.h"
+#include "spdlog/details/os.h"
+#include "spdlog/pattern_formatter.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace caffa;
+
+struct PerThreadFileSink::ThreadFile
+{
+    std::FILE*                         file = nullptr;
+    std::unique_ptr<spdlog::formatter> formatter;
+    uint64_t                           formatterVersion = std::numeric_limits<uint64_t>::max();
+    spdlog::memory_buf_t               formatted;
+
+    /// Held by the writing thread and by flushes, so the thread can write without the locking of stdio
+    std::atomic_flag busy;
+
+    ~ThreadFile()
+    {
+        if ( file ) std::fclose( file );
+    }
+
+    void lock() noexcept
+    {
+        while ( busy.test_and_set( std::memory_order_acquire ) )
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() noexcept { busy.clear( std::memory_order_release ); }
+};
+
+namespace
+{
+// Sinks are told apart by id rather than address in the thread local tables, as addresses get reused
+std::atomic<uint64_t> s_nextSinkId = 1u;
+
+// Ids of the sinks alive, so the thread local tables can drop the entries of destroyed sinks
+struct LiveSinks
+{
+    std::mutex                   mutex;
+    std::unordered_set<uint64_t> ids;
+};
+
+LiveSinks& liveSinks()
+{
+    static LiveSinks sinks;
+    return sinks;
+}
+
+void writeUnlocked( const char* data, size_t size, std::FILE* file )
+{
+#ifdef __GLIBC__
+    fwrite_unlocked( data, 1u, size, file );
+#else
+    std::fwrite( data, 1u, size, file );
+#endif
+}
+
+std::string threadFileName( const std::string& logFile, size_t threadId )
+{
+    auto [basename, extension] = spdlog::details::file_helper::split_by_extension( logFile );
+    return basename + ".thread" + std::to_string( threadId ) + extension;
+}
+
+bool readRecord( std::istream& stream, PerThreadFileSink::Record& record )
+{
+    if ( stream.get() != '#' ) return false;
+
+    size_t length = 0u;
+    stream >> record.sequence >> record.timestamp >> length;
+    if ( !stream || stream.get() != ' ' ) return false;
+
+    record.text.resize( length );
+    stream.read( record.text.data(), static_cast<std::streamsize>( length ) );
+    return static_cast<bool>( stream );
+}
+} // namespace
+
+PerThreadFileSink::PerThreadFileSink( const std::string& logFile )
+    : m_id( s_nextSinkId.fetch_add( 1u ) )
+    , m_logFile( logFile )
+    , m_formatter( std::make_unique<spdlog::pattern_formatter>() )
+{
+    auto directory = std::filesystem::path( m_logFile ).parent_path();
+    if ( !directory.empty() )
+    {
+        std::filesystem::create_directories( directory );
+    }
+
+    std::scoped_lock lock( liveSinks().mutex );
+    liveSinks().ids.insert( m_id );
+}
+
+PerThreadFileSink::~PerThreadFileSink()
+{
+    {
+        std::scoped_lock lock( liveSinks().mutex );
+        liveSinks().ids.erase( m_id );
+    }
+
+    // The thread local tables only refer to the files, so they are all closed here
+    std::scoped_lock lock( m_mutex );
+    for ( auto& [threadId, file] : m_threadFiles )
+    {
+        std::scoped_lock fileLock( *file );
+        std::fflush( file->file );
+        std::fclose( file->file );
+        file->file = nullptr;
+    }
+}
+
+void PerThreadFileSink::log( const spdlog::details::log_msg& msg )
+{
+    auto& file = threadFile();
+    if ( auto version = m_formatterVersion.load( std::memory_order_acquire ); file.formatterVersion != version )
+    {
+        std::scoped_lock lock( m_mutex );
+        file.formatter        = m_formatter->clone();
+        file.formatterVersion = m_formatterVersion.load( std::memory_order_relaxed );
+    }
+
+    file.formatted.clear();
+    file.formatter->format( msg, file.formatted );
+
+    auto sequence  = m_sequence.fetch_add( 1u, std::memory_order_relaxed );
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>( msg.time.time_since_epoch() ).count();
+
+    char prefix[64];
+    auto prefixLength =
+        fmt::format_to_n( prefix, sizeof( prefix ), "#{} {} {} ", sequence, timestamp, file.formatted.size() ).size;
+    std::scoped_lock fileLock( file );
+    writeUnlocked( prefix, prefixLength, file.file );
+    writeUnlocked( file.formatted.data(), file.formatted.size(), file.file );
+}
+
+void PerThreadFileSink::flush()
+{
+    std::scoped_lock lock( m_mutex );
+    for ( const auto& [threadId, file] : m_threadFiles )
+    {
+        std::scoped_lock fileLock( *file );
+        std::fflush( file->file );
+    }
+}
+
+void PerThreadFileSink::set_pattern( const std::string& pattern )
+{
+    set_formatter( std::make_unique<spdlog::pattern_formatter>( pattern ) );
+}
+
+void PerThreadFileSink::set_formatter( std::unique_ptr<spdlog::formatter> sink_formatter )
+{
+    std::scoped_lock lock( m_mutex );
+    m_formatter = std::move( sink_formatter );
+    m_formatterVersion.fetch_add( 1u, std::memory_order_release );
+}
+
+PerThreadFileSink::ThreadFile& PerThreadFileSink::threadFile()
+{
+    thread_local uint64_t    t_lastSinkId = 0u;
+    thread_local ThreadFile* t_lastFile   = nullptr;
+    if ( t_lastSinkId == m_id )
+    {
+        return *t_lastFile;
+    }
+
+    // Only the sink owns the files. The entries of destroyed sinks are never looked up again as sink ids are unique,
+    // and are dropped whenever a new entry is added.
+    thread_local std::unordered_map<uint64_t, ThreadFile*> t_threadFiles;
+
+    if ( !t_threadFiles.empty() && !t_threadFiles.contains( m_id ) )
+    {
+        std::scoped_lock lock( liveSinks().mutex );
+        std::erase_if( t_threadFiles, []( const auto& entry ) { return !liveSinks().ids.contains( entry.first ); } );
+    }
+
+    auto& file = t_threadFiles[m_id];
+    if ( !file )
+    {
+        auto threadId = spdlog::details::os::thread_id();
+
+        std::scoped_lock lock( m_mutex );
+        auto& ownedFile = m_threadFiles[threadId];
+        if ( !ownedFile )
+        {
+            auto fileName = threadFileName( m_logFile, threadId );
+            auto newFile  = std::make_unique<ThreadFile>();
+            newFile->file = std::fopen( fileName.c_str(), "wb" );
+            if ( !newFile->file )
+            {
+                m_threadFiles.erase( threadId );
+                spdlog::throw_spdlog_ex( "Could not open per thread log file " + fileName, errno );
+            }
+            ownedFile = std::move( newFile );
+        }
+        // A thread reusing the id of a finished thread continues the file of that thread
+        file = ownedFile.get();
+    }
+    t_lastSinkId = m_id;
+    t_lastFile   = file;
+    return *file;
+}
+
+std::vector<std::string> PerThreadFileSink::threadFiles( const std::string& logFile )
+{
+    auto [basename, extension] = spdlog::details::file_helper::split_by_extension( logFile );
+
+    std::filesystem::path basePath( basename );
+    auto directory = basePath.has_parent_path() ? basePath.parent_path() : std::filesystem::path( "." );
+    auto prefix    = basePath.filename().string() + ".thread";
+
+    std::vector<std::string> files;
+    std::error_code          error;
+    for ( const auto& entry : std::filesystem::directory_iterator( directory, error ) )
+    {
+        auto name = entry.path().filename().string();
+        if ( name.size() <= prefix.size() + extension.size() || !name.starts_with( prefix ) ||
+             !name.ends_with( extension ) )
+        {
+            continue;
+        }
+        auto threadId = name.substr( prefix.size(), name.size() - prefix.size() - extension.size() );
+        if ( threadId.find_first_not_of( "0123456789" ) == std::string::npos )
+        {
+            files.push_back( entry.path().string() );
+        }
+    }
+    std::sort( files.begin(), files.end() );
+    return files;
+}
+
+void PerThreadFileSink::merge( const std::string& logFile, const std::function<bool( const Record& )>& visitor )
+{
+    struct Reader
+    {
+        std::ifstream stream;
+        Record        record;
+    };
+
+    std::vector<std::unique_ptr<Reader>> readers;
+    for ( const auto& file : threadFiles( logFile ) )
+    {
+        auto reader = std::make_unique<Reader>();
+        reader->stream.open( file, std::ios::binary );
+        if ( readRecord( reader->stream, reader->record ) )
+        {
+            readers.push_back( std::move( reader ) );
+        }
+    }
+
+    // Each thread file is already in sequence order, so a k-way merge on the next record of each is enough
+    auto laterSequence = [&readers]( size_t a, size_t b )
+    { return readers[a]->record.sequence > readers[b]->record.sequence; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype( laterSequence )> next( laterSequence );
+    for ( size_t i = 0; i < readers.size(); ++i )
+    {
+        next.push( i );
+    }
+
+    while ( !next.empty() )
+    {
+        auto i = next.top();
+        next.pop();
+        if ( !visitor( readers[i]->record ) ) return;
+        if ( readRecord( readers[i]->stream, readers[i]->record ) )
+        {
+            next.push( i );
+        }
+    }
+}
@@ -0,0 +1,97 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "spdlog/sinks/sink.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * A file sink for very high write rates where each logging thread writes to a file of its own,
+ * name.thread<id>.ext for a logFile of name.ext, so the threads never wait for each other.
+ * The files are written without the locking of stdio, only a flush waits for the thread writing a file.
+ *
+ * Every record is stamped with a sequence number shared by all threads of the sink and the time of the record:
+ *   #<sequence> <nanoseconds since epoch> <length> <formatted record>
+ * The merge functions below put the records of all the thread files back in sequence order.
+ *
+ * Thread files stay open until the sink is destroyed. The files are not rotated. A thread that gets the id of a
+ * finished thread appends to the file of that thread.
+ */
+class PerThreadFileSink : public spdlog::sinks::sink
+{
+public:
+    struct Record
+    {
+        uint64_t    sequence;
+        int64_t     timestamp; ///< Nanoseconds since the epoch
+        std::string text;      ///< The formatted record including the line ending
+    };
+
+    explicit PerThreadFileSink( const std::string& logFile );
+    ~PerThreadFileSink() override;
+
+    PerThreadFileSink( const PerThreadFileSink& )            = delete;
+    PerThreadFileSink& operator=( const PerThreadFileSink& ) = delete;
+
+    void log( const spdlog::details::log_msg& msg ) override;
+    void flush() override;
+    void set_pattern( const std::string& pattern ) override;
+    void set_formatter( std::unique_ptr<spdlog::formatter> sink_formatter ) override;
+
+    /**
+     * The thread files written for a log file
+     */
+    static std::vector<std::string> threadFiles( const std::string& logFile );
+
+    /**
+     * Read the records of all thread files of a log file in sequence order.
+     * Stops early if the visitor returns false.
+     */
+    static void merge( const std::string& logFile, const std::function<bool( const Record& )>& visitor );
+
+private:
+    struct ThreadFile;
+
+    ThreadFile& threadFile();
+
+    const uint64_t m_id;
+    std::string    m_logFile;
+
+    std::atomic<uint64_t> m_sequence = 0u;
+
+    std::mutex                                    m_mutex;
+    std::unique_ptr<spdlog::formatter>            m_formatter;
+    std::atomic<uint64_t>                         m_formatterVersion = 0u;
+    std::map<size_t, std::unique_ptr<ThreadFile>> m_threadFiles; ///< By thread id
+};
+
+} // namespace caffa
@@ -0,0 +1,50 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+/**
+ * Linux USDT (user statically defined tracing) probes under the provider "caffa", for tracing with bpftrace, perf
+ * or systemtap without rebuilding. An unattached probe is a single nop with its arguments described in an ELF note,
+ * and there is nothing to link at run time. Probes compile away unless the library is built with CAFFA_WITH_USDT
+ * and <sys/sdt.h> (systemtap-sdt-dev) is available.
+ *
+ * Probes:
+ *   log_entry(const char* logger, int level, size_t length), log_return(const char* logger, int level)
+ *   message_drop(int level, size_t count)               level is -1 where the sink does not know it
+ *   rotate_start(const char* file), rotate_end(const char* file)
+ *   flush()
+ *   assert_failed(const char* message)
+ *   uuid_generate_entry(), uuid_generate_return()
+ *
+ * Example: bpftrace -e 'usdt:./libcaffaBase.so:caffa:message_drop { @[arg0] = sum(arg1); }'
+ *
+ * Arguments are evaluated even when no probe is attached, so they should be cheap to produce.
+ */
+#if defined( CAFFA_WITH_USDT ) && __has_include( <sys/sdt.h> )
+#include <sys/sdt.h>
+#define CAFFA_PROBE( name, ... ) STAP_PROBEV( caffa, name __VA_OPT__(, ) __VA_ARGS__ )
+#else
+#define CAFFA_PROBE( name, ... ) \
+    do                           \
+    {                            \
+    } while ( false )
+#endif
@@ -0,0 +1,288 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2021- 3D-Radar AS
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafQueuedSink.h"
+
+#include "cafProbes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+
+using namespace caffa;
+
+namespace
+{
+/**
+ * Logger names are stored once and referred to by pointer from the queue slots.
+ * Each thread remembers the last name it looked up, which is nearly always the one it needs next.
+ */
+const std::string* internLoggerName( spdlog::string_view_t loggerName )
+{
+    thread_local const std::string* t_lastLoggerName = nullptr;
+    if ( t_lastLoggerName && *t_lastLoggerName == std::string_view( loggerName.data(), loggerName.size() ) )
+    {
+        return t_lastLoggerName;
+    }
+
+    static std::mutex                      mutex;
+    static std::unordered_set<std::string> loggerNames;
+
+    std::scoped_lock lock( mutex );
+    t_lastLoggerName = &*loggerNames.emplace( loggerName.data(), loggerName.size() ).first;
+    return t_lastLoggerName;
+}
+} // namespace
+
+QueuedSink::QueuedSink( std::shared_ptr<spdlog::sinks::sink> sink, size_t queueSize, Logger::OverflowPolicy overflowPolicy )
+    : m_sink( sink )
+    , m_overflowPolicy( overflowPolicy )
+    , m_capacity( std::max( queueSize, size_t( 1u ) ) )
+{
+    refreshLevel();
+    setLevelWatermark( Logger::Level::trace, 0.5 );
+    setLevelWatermark( Logger::Level::debug, 0.6 );
+    setLevelWatermark( Logger::Level::info, 0.75 );
+    setLevelWatermark( Logger::Level::warn, 0.9 );
+    setLevelWatermark( Logger::Level::err, 1.0 );
+    setLevelWatermark( Logger::Level::critical, 1.0 );
+
+    std::promise<void> started;
+    m_worker = std::thread( &QueuedSink::processQueue,
+                            this,
+                            Logger::workerThreadConfiguration( Logger::WorkerThread::queuedSink ),
+                            &started );
+    started.get_future().wait();
+}
+
+QueuedSink::~QueuedSink()
+{
+    enqueue( ItemType::terminate, nullptr, nullptr, Logger::OverflowPolicy::block );
+    m_worker.join();
+}
+
+void QueuedSink::log( const spdlog::details::log_msg& msg )
+{
+    enqueue( ItemType::log, &msg, nullptr, m_overflowPolicy );
+}
+
+void QueuedSink::log( const spdlog::details::log_msg& msg, std::string&& payload )
+{
+    enqueue( ItemType::log, &msg, &payload, m_overflowPolicy );
+}
+
+void QueuedSink::flush()
+{
+    // Never wait for room just to flush. The worker will get to the records already queued anyway.
+    enqueue( ItemType::flush, nullptr, nullptr, Logger::OverflowPolicy::discardNew );
+}
+
+void QueuedSink::set_pattern( const std::string& pattern )
+{
+    m_sink->set_pattern( pattern );
+}
+
+void QueuedSink::set_formatter( std::unique_ptr<spdlog::formatter> sink_formatter )
+{
+    m_sink->set_formatter( std::move( sink_formatter ) );
+}
+
+std::shared_ptr<spdlog::sinks::sink> QueuedSink::wrappedSink() const
+{
+    return m_sink;
+}
+
+void QueuedSink::set_level( spdlog::level::level_enum level )
+{
+    m_sink->set_level( level );
+    spdlog::sinks::sink::set_level( level );
+}
+
+spdlog::level::level_enum QueuedSink::level() const
+{
+    return m_sink->level();
+}
+
+void QueuedSink::refreshLevel()
+{
+    spdlog::sinks::sink::set_level( m_sink->level() );
+}
+
+void QueuedSink::setLevelWatermark( Logger::Level level, double fillFraction )
+{
+    auto threshold = static_cast<size_t>( std::clamp( fillFraction, 0.0, 1.0 ) * m_capacity );
+
+    std::scoped_lock lock( m_mutex );
+    m_levelThresholds[static_cast<size_t>( level )] = threshold;
+}
+
+size_t QueuedSink::droppedCount() const
+{
+    size_t dropped = 0u;
+    for ( const auto& count : m_droppedCounts )
+    {
+        dropped += count.load( std::memory_order_relaxed );
+    }
+    return dropped;
+}
+
+std::map<Logger::Level, size_t> QueuedSink::droppedCountPerLevel() const
+{
+    std::map<Logger::Level, size_t> dropped;
+    for ( size_t i = 0; i < m_droppedCounts.size(); ++i )
+    {
+        dropped[static_cast<Logger::Level>( i )] = m_droppedCounts[i].load( std::memory_order_relaxed );
+    }
+    return dropped;
+}
+
+bool QueuedSink::enqueue( ItemType                        type,
+                          const spdlog::details::log_msg* msg,
+                          std::string*                    movablePayload,
+                          Logger::OverflowPolicy          policy )
+{
+    // Looked up before taking the queue lock, as it may have to take the lock of the name table
+    const std::string* loggerName = msg ? internLoggerName( msg->logger_name ) : nullptr;
+    {
+        std::unique_lock lock( m_mutex );
+        if ( msg && policy == Logger::OverflowPolicy::shedByLevel && msg->level != spdlog::level::critical &&
+             m_count >= m_levelThresholds[msg->level] )
+        {
+            countDropped( msg->level );
+            return false;
+        }
+
+        if ( m_count == m_items.size() )
+        {
+            switch ( policy )
+            {
+                case Logger::OverflowPolicy::block:
+                    m_notFull.wait( lock, [this]() { return m_count < m_items.size(); } );
+                    break;
+                case Logger::OverflowPolicy::overrunOldest:
+                case Logger::OverflowPolicy::shedByLevel:
+                {
+                    const auto& oldest = m_items[m_head];
+                    if ( oldest.type == ItemType::log ) countDropped( oldest.level );
+                    m_head = ( m_head + 1 ) % m_items.size();
+                    m_count--;
+                    break;
+                }
+                case Logger::OverflowPolicy::discardNew:
+                    if ( msg ) countDropped( msg->level );
+                    return false;
+            }
+        }
+
+        auto& item = m_items[( m_head + m_count ) % m_items.size()];
+        item.type  = type;
+        if ( msg )
+        {
+            item.level      = msg->level;
+            item.time       = msg->time;
+            item.threadId   = msg->thread_id;
+            item.source     = msg->source;
+            item.loggerName = loggerName;
+            if ( movablePayload )
+            {
+                // Swapped rather than moved so the old slot buffer is released by the caller, outside the lock
+                std::swap( item.payload, *movablePayload );
+            }
+            else
+            {
+                item.payload.assign( msg->payload.data(), msg->payload.size() );
+            }
+        }
+        m_count++;
+    }
+    m_notEmpty.notify_one();
+    return true;
+}
+
+void QueuedSink::countDropped( spdlog::level::level_enum level )
+{
+    m_droppedCounts[static_cast<size_t>( level )].fetch_add( 1u, std::memory_order_relaxed );
+    CAFFA_PROBE( message_drop, static_cast<int>( level ), static_cast<size_t>( 1u ) );
+}
+
+void QueuedSink::processQueue( ThreadConfiguration configuration, std::promise<void>* started )
+{
+    if ( !configuration.applyToCurrentThread() )
+    {
+        std::fprintf( stderr, "[*** LOG ERROR in QueuedSink ***] Could not apply the worker thread configuration\n" );
+    }
+    {
+        // Allocated after the thread has been placed so the memory is local to it
+        std::scoped_lock lock( m_mutex );
+        m_items.resize( m_capacity );
+    }
+    started->set_value();
+
+    Item item;
+    while ( true )
+    {
+        {
+            std::unique_lock lock( m_mutex );
+            m_notEmpty.wait( lock, [this]() { return m_count > 0u; } );
+            std::swap( item, m_items[m_head] );
+            m_head = ( m_head + 1 ) % m_items.size();
+            m_count--;
+        }
+        m_notFull.notify_one();
+
+        switch ( item.type )
+        {
+            case ItemType::log:
+                if ( !m_sink->should_log( item.level ) )
+                {
+                    break;
+                }
+                try
+                {
+                    spdlog::details::log_msg msg( item.time, item.source, *item.loggerName, item.level, item.payload );
+                    msg.thread_id = item.threadId;
+                    m_sink->log( msg );
+                }
+                catch ( const std::exception& e )
+                {
+                    std::fprintf( stderr, "[*** LOG ERROR in QueuedSink ***] %s\n", e.what() );
+                }
+                break;
+            case ItemType::flush:
+                CAFFA_PROBE( flush );
+                flushWrappedSink();
+                break;
+            case ItemType::terminate:
+                flushWrappedSink();
+                return;
+        }
+    }
+}
+
+void QueuedSink::flushWrappedSink()
+{
+    try
+    {
+        m_sink->flush();
+    }
+    catch ( const std::exception& e )
+    {
+        std::fprintf( stderr, "[*** LOG ERROR in QueuedSink ***] %s\n", e.what() );
+    }
+}
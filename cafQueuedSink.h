@@ -0,0 +1,149 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2021- 3D-Radar AS
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "cafLogger.h"
+
+#include "spdlog/details/log_msg.h"
+#include "spdlog/sinks/sink.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * A sink that passes records on to a wrapped sink from its own worker thread through a bounded queue.
+ * Wrap slow sinks (network, remote file systems) in one of these so they cannot stall the other sinks of a logger.
+ * What happens when the queue is full is decided by the overflow policy.
+ *
+ * With OverflowPolicy::shedByLevel each level has a watermark given as a fraction of the queue size.
+ * Records are dropped once the queue is filled beyond the watermark of their level, so lower levels are
+ * shed first as the queue fills up. Critical records are always admitted, overrunning the oldest record if needed.
+ *
+ * The worker thread gets the Logger::WorkerThread::queuedSink configuration and allocates the queue itself,
+ * so the queue memory ends up on the NUMA node the worker is pinned to.
+ *
+ * Queue slots are reused. A slot keeps its payload string between records and refers to the logger name through
+ * an interned copy, so queueing a record does not allocate once the slots have grown to the usual message size.
+ */
+class QueuedSink : public spdlog::sinks::sink
+{
+public:
+    QueuedSink( std::shared_ptr<spdlog::sinks::sink> sink,
+                size_t                               queueSize      = 8192u,
+                Logger::OverflowPolicy               overflowPolicy = Logger::OverflowPolicy::discardNew );
+    ~QueuedSink() override;
+
+    QueuedSink( const QueuedSink& )            = delete;
+    QueuedSink& operator=( const QueuedSink& ) = delete;
+
+    void log( const spdlog::details::log_msg& msg ) override;
+
+    /**
+     * Queue a record, taking over the payload string instead of copying it.
+     * The payload of msg has to refer to the contents of payload.
+     */
+    void log( const spdlog::details::log_msg& msg, std::string&& payload );
+    void flush() override;
+    void set_pattern( const std::string& pattern ) override;
+    void set_formatter( std::unique_ptr<spdlog::formatter> sink_formatter ) override;
+
+    std::shared_ptr<spdlog::sinks::sink> wrappedSink() const;
+
+    /**
+     * The level of a queued sink is the level of the wrapped sink. These hide the non-virtual versions in
+     * spdlog::sinks::sink, which keep a copy of the level so records the wrapped sink drops are not queued at all.
+     * The worker checks the level of the wrapped sink again, in case it is set directly.
+     */
+    void                      set_level( spdlog::level::level_enum level );
+    spdlog::level::level_enum level() const;
+
+    /**
+     * Take over the level of the wrapped sink after it has been set directly on that sink
+     */
+    void refreshLevel();
+
+    /**
+     * Set the fill fraction of the queue beyond which records of the given level are dropped.
+     * Only used with OverflowPolicy::shedByLevel.
+     */
+    void setLevelWatermark( Logger::Level level, double fillFraction );
+
+    /**
+     * Number of records dropped because the queue was full
+     */
+    size_t                          droppedCount() const;
+    std::map<Logger::Level, size_t> droppedCountPerLevel() const;
+
+private:
+    enum class ItemType
+    {
+        log,
+        flush,
+        terminate
+    };
+
+    struct Item
+    {
+        ItemType                      type  = ItemType::log;
+        spdlog::level::level_enum     level = spdlog::level::off;
+        spdlog::log_clock::time_point time;
+        size_t                        threadId = 0u;
+        spdlog::source_loc            source;
+        const std::string*            loggerName = nullptr;
+        std::string                   payload;
+    };
+
+    bool enqueue( ItemType                        type,
+                  const spdlog::details::log_msg* msg,
+                  std::string*                    movablePayload,
+                  Logger::OverflowPolicy          policy );
+    void processQueue( ThreadConfiguration configuration, std::promise<void>* started );
+    void flushWrappedSink();
+    void countDropped( spdlog::level::level_enum level );
+
+    static constexpr size_t LevelCount = static_cast<size_t>( Logger::Level::n_levels );
+
+    std::shared_ptr<spdlog::sinks::sink> m_sink;
+    Logger::OverflowPolicy               m_overflowPolicy;
+    size_t                               m_capacity;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::vector<Item>       m_items;
+    size_t                  m_head  = 0u;
+    size_t                  m_count = 0u;
+
+    std::array<size_t, LevelCount>              m_levelThresholds{};
+    std::array<std::atomic<size_t>, LevelCount> m_droppedCounts{};
+    std::thread                                 m_worker;
+};
+
+} // namespace caffa
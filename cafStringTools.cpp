@@ -3,15 +3,512 @@
 #include "cafAssert.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
+#include <charconv>
 #include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define CAFFA_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+#if defined( CAFFA_SEARCH_X86 ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define CAFFA_SEARCH_AVX2 1
+#define CAFFA_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#elif defined( CAFFA_SEARCH_X86 ) && defined( __AVX2__ )
+#define CAFFA_SEARCH_AVX2 1
+#define CAFFA_TARGET_AVX2
+#endif
+
+using namespace caffa;
+
+namespace
+{
+//--------------------------------------------------------------------------------------------------
+/// Compare the parts of a candidate the vectorised filters did not already check
+//--------------------------------------------------------------------------------------------------
+inline bool middleMatches( const char* candidate, std::string_view needle ) noexcept
+{
+    return needle.size() <= 2u || std::memcmp( candidate + 1, needle.data() + 1, needle.size() - 2u ) == 0;
+}
+
+size_t findScalar( std::string_view haystack, std::string_view needle, size_t pos ) noexcept
+{
+    return haystack.find( needle, pos );
+}
+
+#ifdef CAFFA_SEARCH_X86
+//--------------------------------------------------------------------------------------------------
+/// Check 16 positions at a time for the first and last byte of the needle
+//--------------------------------------------------------------------------------------------------
+size_t findSSE2( std::string_view haystack, std::string_view needle, size_t pos ) noexcept
+{
+    const char*   text  = haystack.data();
+    const size_t  n     = needle.size();
+    const __m128i first = _mm_set1_epi8( needle.front() );
+    const __m128i last  = _mm_set1_epi8( needle.back() );
+
+    for ( ; pos + n - 1u + 16u <= haystack.size(); pos += 16u )
+    {
+        const __m128i blockFirst = _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + pos ) );
+        const __m128i blockLast  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + pos + n - 1u ) );
+
+        auto mask = static_cast<uint32_t>( _mm_movemask_epi8(
+            _mm_and_si128( _mm_cmpeq_epi8( first, blockFirst ), _mm_cmpeq_epi8( last, blockLast ) ) ) );
+        for ( ; mask != 0u; mask &= mask - 1u )
+        {
+            size_t candidate = pos + std::countr_zero( mask );
+            if ( middleMatches( text + candidate, needle ) ) return candidate;
+        }
+    }
+    return haystack.find( needle, pos );
+}
+#endif
+
+#ifdef CAFFA_SEARCH_AVX2
+//--------------------------------------------------------------------------------------------------
+/// Check 32 positions at a time for the first and last byte of the needle
+//--------------------------------------------------------------------------------------------------
+CAFFA_TARGET_AVX2 size_t findAVX2( std::string_view haystack, std::string_view needle, size_t pos ) noexcept
+{
+    const char*   text  = haystack.data();
+    const size_t  n     = needle.size();
+    const __m256i first = _mm256_set1_epi8( needle.front() );
+    const __m256i last  = _mm256_set1_epi8( needle.back() );
+
+    for ( ; pos + n - 1u + 32u <= haystack.size(); pos += 32u )
+    {
+        const __m256i blockFirst = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( text + pos ) );
+        const __m256i blockLast  = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( text + pos + n - 1u ) );
+
+        auto mask = static_cast<uint32_t>( _mm256_movemask_epi8(
+            _mm256_and_si256( _mm256_cmpeq_epi8( first, blockFirst ), _mm256_cmpeq_epi8( last, blockLast ) ) ) );
+        for ( ; mask != 0u; mask &= mask - 1u )
+        {
+            size_t candidate = pos + std::countr_zero( mask );
+            if ( middleMatches( text + candidate, needle ) ) return candidate;
+        }
+    }
+    return findSSE2( haystack, needle, pos );
+}
+#endif
+
+using FindFunction = size_t ( * )( std::string_view, std::string_view, size_t ) noexcept;
+
+FindFunction findFunction( StringTools::SearchEngine engine ) noexcept
+{
+    switch ( engine )
+    {
+#ifdef CAFFA_SEARCH_AVX2
+        case StringTools::SearchEngine::AVX2:
+            return findAVX2;
+#endif
+#ifdef CAFFA_SEARCH_X86
+        case StringTools::SearchEngine::SSE2:
+            return findSSE2;
+#endif
+        default:
+            return findScalar;
+    }
+}
+
+bool cpuSupportsAVX2() noexcept
+{
+#if defined( CAFFA_SEARCH_AVX2 ) && defined( __AVX2__ )
+    return true;
+#elif defined( CAFFA_SEARCH_AVX2 )
+    return __builtin_cpu_supports( "avx2" );
+#else
+    return false;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Length of a bracketed character class starting at pos, or zero if it is not terminated
+//--------------------------------------------------------------------------------------------------
+size_t classLength( std::string_view pattern, size_t pos ) noexcept
+{
+    size_t i = pos + 1u;
+    if ( i < pattern.size() && pattern[i] == '^' ) ++i;
+    if ( i < pattern.size() && pattern[i] == ']' ) ++i;
+    while ( i < pattern.size() && pattern[i] != ']' )
+    {
+        if ( pattern[i] == '\\' )
+        {
+            i += 2u;
+        }
+        else if ( pattern[i] == '[' && i + 1u < pattern.size() &&
+                  std::string_view( ":=." ).find( pattern[i + 1u] ) != std::string_view::npos )
+        {
+            // [:alpha:], [=a=] or [.a.]
+            const char close[] = { pattern[i + 1u], ']' };
+            auto       end     = pattern.find( std::string_view( close, 2u ), i + 2u );
+            if ( end == std::string_view::npos ) return 0u;
+            i = end + 2u;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return i < pattern.size() ? i + 1u - pos : 0u;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Length of a single character matching atom starting at pos, or zero if it is something else
+//--------------------------------------------------------------------------------------------------
+size_t atomLength( std::string_view pattern, size_t pos ) noexcept
+{
+    const char c = pattern[pos];
+    if ( c == '\\' )
+    {
+        if ( pos + 1u >= pattern.size() ) return 0u;
+        const char escaped = pattern[pos + 1u];
+        // Escaped punctuation and the character class and control character escapes. Not anchors or references.
+        if ( std::isalnum( static_cast<unsigned char>( escaped ) ) &&
+             std::string_view( "sSdDwWtnrfv" ).find( escaped ) == std::string_view::npos )
+        {
+            return 0u;
+        }
+        return 2u;
+    }
+    if ( c == '[' ) return classLength( pattern, pos );
+    if ( std::string_view( "^$()|*+?{}" ).find( c ) != std::string_view::npos ) return 0u;
+    return 1u;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Parse a quantifier at pos. Returns false if it cannot be parsed.
+//--------------------------------------------------------------------------------------------------
+bool parseQuantifier( std::string_view pattern, size_t pos, size_t& minimum, size_t& length ) noexcept
+{
+    minimum = 1u;
+    length  = 0u;
+    if ( pos >= pattern.size() ) return true;
+
+    switch ( pattern[pos] )
+    {
+        case '*':
+        case '?':
+            minimum = 0u;
+            length  = 1u;
+            break;
+        case '+':
+            length = 1u;
+            break;
+        case '{':
+        {
+            auto close = pattern.find( '}', pos );
+            if ( close == std::string_view::npos ) return false;
+            auto [end, error] = std::from_chars( pattern.data() + pos + 1u, pattern.data() + close, minimum );
+            if ( error != std::errc() || ( *end != ',' && *end != '}' ) ) return false;
+            length = close + 1u - pos;
+            break;
+        }
+        default:
+            return true;
+    }
+    // Lazy and possessive versions
+    if ( pos + length < pattern.size() && ( pattern[pos + length] == '?' || pattern[pos + length] == '+' ) ) ++length;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Position of the | ending the alternative containing pos, or the end of the pattern
+//--------------------------------------------------------------------------------------------------
+size_t endOfAlternative( std::string_view pattern, size_t pos ) noexcept
+{
+    int depth = 0;
+    while ( pos < pattern.size() )
+    {
+        const char c = pattern[pos];
+        if ( c == '\\' )
+        {
+            pos += 2u;
+            continue;
+        }
+        if ( c == '[' )
+        {
+            auto length = classLength( pattern, pos );
+            pos += std::max( length, size_t( 1u ) );
+            continue;
+        }
+        if ( c == '(' ) depth++;
+        if ( c == ')' ) depth--;
+        if ( c == '|' && depth == 0 ) return pos;
+        ++pos;
+    }
+    return pattern.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// What a match of a pattern has to look like: it has to contain one of the required characters,
+/// and everything in front of that within the match has to be one of the prefix characters.
+//--------------------------------------------------------------------------------------------------
+struct RegexPrefilter
+{
+    std::array<bool, 256> prefix{};
+    std::array<bool, 256> required{};
+};
+
+//--------------------------------------------------------------------------------------------------
+/// Every top level alternative has to start with optional single character atoms followed by one that is
+/// required. Whatever follows that required atom, groups included, is not looked at since the regex engine
+/// verifies it anyway. The characters each atom matches are found by asking the regex engine itself, so
+/// classes, locales and icase all agree.
+//--------------------------------------------------------------------------------------------------
+std::optional<RegexPrefilter> analysePattern( std::string_view pattern, boost::regex::flag_type flags )
+{
+    constexpr auto unsupported = boost::regex::main_option_type | boost::regex::no_escape_in_lists |
+                                 boost::regex::newline_alt | boost::regex::mod_x | boost::regex::no_except;
+    if ( ( flags & unsupported ) != 0 ) return std::nullopt;
+
+    RegexPrefilter prefilter;
+    size_t         pos = 0u;
+    while ( true )
+    {
+        bool optional = true;
+        while ( optional && pos < pattern.size() && pattern[pos] != '|' )
+        {
+            size_t atom = atomLength( pattern, pos );
+            if ( atom == 0u ) return std::nullopt;
+
+            size_t minimum = 0u, quantifier = 0u;
+            if ( !parseQuantifier( pattern, pos + atom, minimum, quantifier ) ) return std::nullopt;
+
+            optional         = minimum == 0u;
+            auto& characters = optional ? prefilter.prefix : prefilter.required;
+
+            boost::regex atomRegex( pattern.data() + pos, pattern.data() + pos + atom, flags );
+            for ( size_t i = 0u; i < characters.size(); ++i )
+            {
+                const char c = static_cast<char>( i );
+                characters[i] |= boost::regex_match( &c, &c + 1, atomRegex );
+            }
+            pos += atom + quantifier;
+        }
+        // The pattern can match an empty string, so nothing is required
+        if ( optional ) return std::nullopt;
+
+        pos = endOfAlternative( pattern, pos );
+        if ( pos >= pattern.size() ) return prefilter;
+        ++pos;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Case folding of ASCII letters only, so it is independent of the locale and works on UTF-8 too
+//--------------------------------------------------------------------------------------------------
+constexpr char lowerAscii( char c ) noexcept
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>( c | 0x20 ) : c;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Lower case eight ASCII characters at once. The high bit of each byte tells if it is an upper case letter.
+//--------------------------------------------------------------------------------------------------
+constexpr uint64_t lowerAscii( uint64_t word ) noexcept
+{
+    constexpr uint64_t ones     = 0x0101010101010101u;
+    constexpr uint64_t highBits = 0x8080808080808080u;
+
+    const uint64_t heptets   = word & ~highBits;
+    const uint64_t aboveZ    = heptets + ( 0x7f - 'Z' ) * ones;
+    const uint64_t atLeastA  = heptets + ( 0x80 - 'A' ) * ones;
+    const uint64_t upperCase = ~word & ( atLeastA ^ aboveZ ) & highBits;
+    return word | ( upperCase >> 2u );
+}
+
+inline uint64_t load64( const char* data ) noexcept
+{
+    uint64_t word;
+    std::memcpy( &word, data, sizeof( word ) );
+    return word;
+}
+
+bool equalsIgnoringCase( const char* lhs, const char* rhs, size_t length ) noexcept
+{
+    size_t i = 0u;
+    for ( ; i + 8u <= length; i += 8u )
+    {
+        if ( lowerAscii( load64( lhs + i ) ) != lowerAscii( load64( rhs + i ) ) ) return false;
+    }
+    for ( ; i < length; ++i )
+    {
+        if ( lowerAscii( lhs[i] ) != lowerAscii( rhs[i] ) ) return false;
+    }
+    return true;
+}
+
+#ifdef CAFFA_SEARCH_X86
+//--------------------------------------------------------------------------------------------------
+/// Flip the case bit of the bytes in the range [First, Last]. Bytes above 0x7f are negative and never in range.
+//--------------------------------------------------------------------------------------------------
+template <char First, char Last>
+inline __m128i flipCase( __m128i block ) noexcept
+{
+    const __m128i inRange = _mm_and_si128( _mm_cmpgt_epi8( block, _mm_set1_epi8( First - 1 ) ),
+                                           _mm_cmpgt_epi8( _mm_set1_epi8( Last + 1 ), block ) );
+    return _mm_xor_si128( block, _mm_and_si128( inRange, _mm_set1_epi8( 0x20 ) ) );
+}
+
+inline __m128i lowerAscii( __m128i block ) noexcept
+{
+    return flipCase<'A', 'Z'>( block );
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/// Flip the case of all letters in [First, Last], which is either the lower or upper case alphabet
+//--------------------------------------------------------------------------------------------------
+template <char First, char Last>
+void changeCase( std::span<char> data ) noexcept
+{
+    size_t i = 0u;
+#ifdef CAFFA_SEARCH_X86
+    for ( ; i + 16u <= data.size(); i += 16u )
+    {
+        auto* block = reinterpret_cast<__m128i*>( data.data() + i );
+        _mm_storeu_si128( block, flipCase<First, Last>( _mm_loadu_si128( block ) ) );
+    }
+#endif
+    for ( ; i < data.size(); ++i )
+    {
+        if ( data[i] >= First && data[i] <= Last ) data[i] = static_cast<char>( data[i] ^ 0x20 );
+    }
+}
+
+using RegexKey     = std::pair<std::string, boost::regex::flag_type>;
+using RegexKeyView = std::pair<std::string_view, boost::regex::flag_type>;
+
+struct RegexKeyHash
+{
+    using is_transparent = void;
+
+    size_t operator()( const RegexKeyView& key ) const noexcept
+    {
+        return std::hash<std::string_view>{}( key.first ) ^
+               ( std::hash<boost::regex::flag_type>{}( key.second ) << 1u );
+    }
+    size_t operator()( const RegexKey& key ) const noexcept
+    {
+        return ( *this )( RegexKeyView( key.first, key.second ) );
+    }
+};
+
+struct RegexKeyEqual
+{
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()( const A& lhs, const B& rhs ) const noexcept
+    {
+        return lhs.second == rhs.second && std::string_view( lhs.first ) == std::string_view( rhs.first );
+    }
+};
+
+struct RegexCache
+{
+    // Patterns are usually a fixed set in the code, so the cache is simply emptied if something builds them on the fly
+    static constexpr size_t MAX_ENTRIES = 256u;
+
+    using Entry   = std::shared_ptr<const StringTools::CompiledRegex>;
+    using Entries = std::unordered_map<RegexKey, Entry, RegexKeyHash, RegexKeyEqual>;
+
+    std::mutex mutex;
+    Entries    entries;
+};
+
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+StringTools::SearchEngine StringTools::bestSearchEngine() noexcept
+{
+    static const SearchEngine engine = supportedSearchEngines().back();
+    return engine;
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::vector<StringTools::SearchEngine> StringTools::supportedSearchEngines()
+{
+    std::vector<SearchEngine> engines = { SearchEngine::Scalar };
+#ifdef CAFFA_SEARCH_X86
+    // SSE2 is part of the x86-64 baseline
+    engines.push_back( SearchEngine::SSE2 );
+#endif
+    if ( cpuSupportsAVX2() ) engines.push_back( SearchEngine::AVX2 );
+    return engines;
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+size_t StringTools::find( SearchEngine     engine,
+                          std::string_view haystack,
+                          std::string_view needle,
+                          size_t           pos ) noexcept
+{
+    if ( needle.size() <= 1u || pos >= haystack.size() )
+    {
+        return haystack.find( needle, pos );
+    }
+    return findFunction( engine )( haystack, needle, pos );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+size_t StringTools::find( std::string_view haystack, std::string_view needle, size_t pos ) noexcept
+{
+    static const FindFunction function = findFunction( bestSearchEngine() );
+
+    if ( needle.size() <= 1u || pos >= haystack.size() )
+    {
+        // Single characters go to memchr, which the C library already vectorises
+        return haystack.find( needle, pos );
+    }
+    return function( haystack, needle, pos );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+size_t StringTools::find( std::string_view haystack, char needle, size_t pos ) noexcept
+{
+    if ( pos >= haystack.size() ) return std::string_view::npos;
+
+    auto match = static_cast<const char*>( std::memchr( haystack.data() + pos, needle, haystack.size() - pos ) );
+    return match ? static_cast<size_t>( match - haystack.data() ) : std::string_view::npos;
+}
 
 //--------------------------------------------------------------------------------------------------
 ///
 //--------------------------------------------------------------------------------------------------
 std::string caffa::StringTools::trim( std::string s )
 {
-    s.erase( s.begin(), std::find_if( s.begin(), s.end(), []( unsigned char ch ) { return !std::isspace( ch ); } ) );
-    s.erase( std::find_if( s.rbegin(), s.rend(), []( unsigned char ch ) { return !std::isspace( ch ); } ).base(), s.end() );
+    auto trimmed = trim_view( s );
+    s.erase( static_cast<size_t>( trimmed.data() - s.data() ) + trimmed.size() );
+    s.erase( 0u, static_cast<size_t>( trimmed.data() - s.data() ) );
+    return s;
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::string_view caffa::StringTools::trim_view( std::string_view s ) noexcept
+{
+    while ( !s.empty() && isspace( s.front() ) )
+        s.remove_prefix( 1u );
+    while ( !s.empty() && isspace( s.back() ) )
+        s.remove_suffix( 1u );
     return s;
 }
 
@@ -20,24 +517,316 @@ std::string caffa::StringTools::trim( std::string s )
 //--------------------------------------------------------------------------------------------------
 std::string caffa::StringTools::tolower( std::string data )
 {
-    std::transform( data.begin(), data.end(), data.begin(), []( unsigned char c ) { return (char)std::tolower( c ); } );
+    tolower_in_place( data );
     return data;
 }
 
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::string caffa::StringTools::toupper( std::string data )
+{
+    toupper_in_place( data );
+    return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+void caffa::StringTools::tolower_in_place( std::span<char> data ) noexcept
+{
+    changeCase<'A', 'Z'>( data );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+void caffa::StringTools::toupper_in_place( std::span<char> data ) noexcept
+{
+    changeCase<'a', 'z'>( data );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+bool caffa::StringTools::iequals( std::string_view lhs, std::string_view rhs ) noexcept
+{
+    return lhs.size() == rhs.size() && equalsIgnoringCase( lhs.data(), rhs.data(), lhs.size() );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::weak_ordering caffa::StringTools::icompare( std::string_view lhs, std::string_view rhs ) noexcept
+{
+    const size_t length = std::min( lhs.size(), rhs.size() );
+
+    size_t i = 0u;
+    for ( ; i + 8u <= length; i += 8u )
+    {
+        if ( lowerAscii( load64( lhs.data() + i ) ) != lowerAscii( load64( rhs.data() + i ) ) ) break;
+    }
+    for ( ; i < length; ++i )
+    {
+        auto l = static_cast<unsigned char>( lowerAscii( lhs[i] ) );
+        auto r = static_cast<unsigned char>( lowerAscii( rhs[i] ) );
+        if ( l != r ) return l <=> r;
+    }
+    return lhs.size() <=> rhs.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+size_t caffa::StringTools::ifind( std::string_view haystack, std::string_view needle, size_t pos ) noexcept
+{
+    if ( pos > haystack.size() || needle.size() > haystack.size() - pos ) return std::string_view::npos;
+    if ( needle.empty() ) return pos;
+
+    const char*  text  = haystack.data();
+    const size_t n     = needle.size();
+    const char   first = lowerAscii( needle.front() );
+    const char   last  = lowerAscii( needle.back() );
+
+#ifdef CAFFA_SEARCH_X86
+    // The same first and last byte filter as find(), on lower cased blocks
+    const __m128i firstBlock = _mm_set1_epi8( first );
+    const __m128i lastBlock  = _mm_set1_epi8( last );
+    auto loadLower = [text]( size_t at )
+    { return lowerAscii( _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + at ) ) ); };
+    for ( ; pos + n - 1u + 16u <= haystack.size(); pos += 16u )
+    {
+        const __m128i blockFirst = loadLower( pos );
+        const __m128i blockLast  = loadLower( pos + n - 1u );
+
+        auto mask = static_cast<uint32_t>( _mm_movemask_epi8(
+            _mm_and_si128( _mm_cmpeq_epi8( firstBlock, blockFirst ), _mm_cmpeq_epi8( lastBlock, blockLast ) ) ) );
+        for ( ; mask != 0u; mask &= mask - 1u )
+        {
+            size_t candidate = pos + std::countr_zero( mask );
+            if ( equalsIgnoringCase( text + candidate, needle.data(), n ) ) return candidate;
+        }
+    }
+#endif
+    for ( ; pos + n <= haystack.size(); ++pos )
+    {
+        if ( lowerAscii( text[pos] ) == first && equalsIgnoringCase( text + pos, needle.data(), n ) )
+        {
+            return pos;
+        }
+    }
+    return std::string_view::npos;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Hashes eight lower case characters at a time
+//--------------------------------------------------------------------------------------------------
+size_t caffa::StringTools::ihash( std::string_view s ) noexcept
+{
+    constexpr uint64_t multiplier = 0x9e3779b97f4a7c15u;
+
+    uint64_t hash = s.size() * multiplier;
+    size_t   i    = 0u;
+    for ( ; i + 8u <= s.size(); i += 8u )
+    {
+        hash = ( std::rotl( hash, 5 ) ^ lowerAscii( load64( s.data() + i ) ) ) * multiplier;
+    }
+    if ( i < s.size() )
+    {
+        uint64_t tail = 0u;
+        std::memcpy( &tail, s.data() + i, s.size() - i );
+        hash = ( std::rotl( hash, 5 ) ^ lowerAscii( tail ) ) * multiplier;
+    }
+    return static_cast<size_t>( hash ^ ( hash >> 32u ) );
+}
+
 //--------------------------------------------------------------------------------------------------
 ///
 //--------------------------------------------------------------------------------------------------
 std::string caffa::StringTools::replace( const std::string& data, const std::string& what, const std::string& with )
 {
-    std::string out   = data;
-    size_t      count = 0;
-    for ( size_t pos = 0; out.npos != ( pos = out.find( what.data(), pos, what.length() ) ); pos += with.length(), ++count )
+    size_t pos = what.empty() ? std::string::npos : StringTools::find( data, what );
+    if ( pos == std::string::npos ) return data;
+
+    // Build the result in one pass instead of shifting the tail of the string for every match
+    std::string out;
+    out.reserve( data.size() );
+    size_t start = 0u;
+    while ( pos != std::string::npos )
+    {
+        out.append( data, start, pos - start );
+        out.append( with );
+        start = pos + what.length();
+        pos   = StringTools::find( data, what, start );
+    }
+    out.append( data, start, std::string::npos );
+    return out;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Builds the trie of all patterns, then turns it into a complete automaton breadth first, where missing
+/// transitions go where the failure links would take them. Bytes that do not appear in any pattern share
+/// one column in the transition table, which keeps the table small.
+//--------------------------------------------------------------------------------------------------
+StringTools::MultiReplace::MultiReplace( const Replacements& replacements )
+{
+    for ( const auto& [what, with] : replacements )
     {
-        out.replace( pos, what.length(), with.data(), with.length() );
+        if ( what.empty() ) throw std::invalid_argument( "Cannot replace an empty string" );
+        for ( char c : what )
+        {
+            auto& byteClass = m_byteClasses[static_cast<unsigned char>( c )];
+            if ( byteClass == 0u ) byteClass = static_cast<uint16_t>( m_classCount++ );
+        }
     }
+
+    constexpr uint32_t none = 0u; // The root is never a child, so zero can mark a missing trie edge
+    m_transitions.assign( m_classCount, none );
+    m_depths.push_back( 0u );
+    m_outputs.push_back( -1 );
+
+    for ( const auto& [what, with] : replacements )
+    {
+        uint32_t state = 0u;
+        for ( char c : what )
+        {
+            const size_t edge = state * m_classCount + m_byteClasses[static_cast<unsigned char>( c )];
+            if ( m_transitions[edge] == none )
+            {
+                m_transitions[edge] = static_cast<uint32_t>( m_depths.size() );
+                m_transitions.resize( m_transitions.size() + m_classCount, none );
+                m_depths.push_back( m_depths[state] + 1u );
+                m_outputs.push_back( -1 );
+            }
+            state = m_transitions[edge];
+        }
+        if ( m_outputs[state] >= 0 )
+        {
+            m_with[m_outputs[state]] = with;
+            continue;
+        }
+        m_outputs[state] = static_cast<int32_t>( m_with.size() );
+        m_patternLengths.push_back( what.size() );
+        m_with.push_back( with );
+
+        m_startsPattern[static_cast<unsigned char>( what.front() )] = true;
+    }
+
+    // Each state takes over the longest match of its failure state if it is not a match itself,
+    // which is the longest pattern ending at the same place.
+    std::vector<uint32_t> failures( m_depths.size(), 0u );
+    std::vector<uint32_t> queue;
+    for ( size_t c = 0u; c < m_classCount; ++c )
+    {
+        if ( auto child = m_transitions[c]; child != none ) queue.push_back( child );
+    }
+    for ( size_t head = 0u; head < queue.size(); ++head )
+    {
+        const uint32_t state = queue[head];
+        if ( m_outputs[state] < 0 ) m_outputs[state] = m_outputs[failures[state]];
+
+        for ( size_t c = 0u; c < m_classCount; ++c )
+        {
+            auto& child        = m_transitions[state * m_classCount + c];
+            auto  failureChild = m_transitions[failures[state] * m_classCount + c];
+            if ( child == none )
+            {
+                child = failureChild;
+            }
+            else
+            {
+                failures[child] = failureChild;
+                queue.push_back( child );
+            }
+        }
+    }
+
+    m_startCount = std::ranges::count( m_startsPattern, true );
+    m_startByte  = static_cast<char>( std::ranges::find( m_startsPattern, true ) - m_startsPattern.begin() );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::string StringTools::MultiReplace::apply( std::string_view text ) const
+{
+    std::string out;
+    apply_to( out, text );
+    return out;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The best match so far is kept until no later match can start at or before it. That is the case once the
+/// current state no longer reaches back to its start. After writing out a replacement the search starts over
+/// right behind it, so matches that were seen but overlapped the replacement are dropped.
+//--------------------------------------------------------------------------------------------------
+std::string& StringTools::MultiReplace::apply_to( std::string& out, std::string_view text ) const
+{
+    out.reserve( out.size() + text.size() );
+
+    // The leftmost-longest match found so far, if bestStart is not npos
+    constexpr size_t noMatch     = std::string_view::npos;
+    size_t           bestStart   = noMatch;
+    size_t           bestLength  = 0u;
+    size_t           bestPattern = 0u;
+
+    size_t   written = 0u;
+    uint32_t state   = 0u;
+    for ( size_t i = 0u; i <= text.size(); )
+    {
+        if ( state == 0u && bestStart == noMatch && m_startCount > 0u )
+        {
+            // Jump straight to the next character a pattern starts with
+            if ( m_startCount == 1u )
+            {
+                i = StringTools::find( text, m_startByte, i );
+            }
+            else
+            {
+                while ( i < text.size() && !m_startsPattern[static_cast<unsigned char>( text[i] )] )
+                    ++i;
+            }
+            if ( i >= text.size() ) break;
+        }
+
+        if ( i < text.size() ) state = next( state, text[i] );
+        if ( bestStart != noMatch && ( i == text.size() || i + 1u - m_depths[state] > bestStart ) )
+        {
+            out.append( text.substr( written, bestStart - written ) );
+            out.append( m_with[bestPattern] );
+            written   = bestStart + bestLength;
+            i         = written;
+            state     = 0u;
+            bestStart = noMatch;
+            continue;
+        }
+        if ( i == text.size() ) break;
+
+        if ( auto pattern = m_outputs[state]; pattern >= 0 )
+        {
+            const size_t length = m_patternLengths[pattern];
+            const size_t start  = i + 1u - length;
+            if ( start < bestStart || ( start == bestStart && length > bestLength ) )
+            {
+                bestStart   = start;
+                bestLength  = length;
+                bestPattern = static_cast<size_t>( pattern );
+            }
+        }
+        ++i;
+    }
+    out.append( text.substr( written ) );
     return out;
 }
 
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::string caffa::StringTools::replace_many( std::string_view data, const MultiReplace::Replacements& replacements )
+{
+    return MultiReplace( replacements ).apply( data );
+}
+
 std::optional<int64_t> caffa::StringTools::toInt64( const std::string& string )
 {
     char*   endptr;
@@ -81,3 +870,104 @@ std::optional<double> caffa::StringTools::toDouble( const std::string& string )
     }
     return std::optional<double>();
 }
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::shared_ptr<const StringTools::CompiledRegex> StringTools::CompiledRegex::get( std::string_view        pattern,
+                                                                                   boost::regex::flag_type flags )
+{
+    // Leaked on purpose, so it can be used during static destruction
+    static auto* cache = new RegexCache;
+
+    std::scoped_lock lock( cache->mutex );
+    if ( auto it = cache->entries.find( RegexKeyView( pattern, flags ) ); it != cache->entries.end() )
+    {
+        return it->second;
+    }
+
+    auto compiled = std::make_shared<const CompiledRegex>( pattern, flags );
+    if ( cache->entries.size() >= RegexCache::MAX_ENTRIES ) cache->entries.clear();
+    cache->entries.emplace( RegexKey( pattern, flags ), compiled );
+    return compiled;
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+StringTools::CompiledRegex::CompiledRegex( std::string_view pattern, boost::regex::flag_type flags )
+    : m_regex( pattern.data(), pattern.data() + pattern.size(), flags )
+{
+    auto prefilter = analysePattern( pattern, flags );
+    if ( !prefilter ) return;
+
+    size_t count = std::ranges::count( prefilter->required, true );
+    // With most characters being candidates the regex engine is better off searching on its own
+    if ( count == 0u || count > prefilter->required.size() / 2u ) return;
+
+    auto firstRequired = std::ranges::find( prefilter->required, true );
+
+    m_prefixCharacters       = prefilter->prefix;
+    m_requiredCharacters     = prefilter->required;
+    m_requiredCharacterCount = count;
+    m_requiredCharacter      = static_cast<char>( firstRequired - prefilter->required.begin() );
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+std::pair<size_t, size_t> StringTools::CompiledRegex::search( std::string_view text, size_t pos ) const
+{
+    const char*   begin = text.data();
+    const char*   end   = begin + text.size();
+    boost::cmatch match;
+
+    if ( pos > text.size() ) return { std::string_view::npos, 0u };
+
+    if ( !hasPrefilter() )
+    {
+        auto flags = pos > 0u ? boost::match_prev_avail : boost::match_default;
+        if ( boost::regex_search( begin + pos, end, match, m_regex, flags ) )
+        {
+            return { static_cast<size_t>( match[0].first - begin ), static_cast<size_t>( match.length( 0 ) ) };
+        }
+        return { std::string_view::npos, 0u };
+    }
+
+    // A match has to start in the run of prefix characters right before a required character.
+    // Try those positions from the left, and never the same position twice.
+    size_t untried = pos;
+    for ( size_t required = nextRequired( text, pos ); required != std::string_view::npos;
+          required        = nextRequired( text, required + 1u ) )
+    {
+        size_t start = required;
+        while ( start > untried && m_prefixCharacters[static_cast<unsigned char>( text[start - 1u] )] )
+        {
+            --start;
+        }
+        for ( start = std::max( start, untried ); start <= required; ++start )
+        {
+            auto flags = boost::match_continuous | ( start > 0u ? boost::match_prev_avail : boost::match_default );
+            if ( boost::regex_search( begin + start, end, match, m_regex, flags ) )
+            {
+                return { start, static_cast<size_t>( match.length( 0 ) ) };
+            }
+        }
+        untried = required + 1u;
+    }
+    return { std::string_view::npos, 0u };
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+size_t StringTools::CompiledRegex::nextRequired( std::string_view text, size_t pos ) const noexcept
+{
+    if ( m_requiredCharacterCount == 1u ) return StringTools::find( text, m_requiredCharacter, pos );
+
+    for ( ; pos < text.size(); ++pos )
+    {
+        if ( m_requiredCharacters[static_cast<unsigned char>( text[pos] )] ) return pos;
+    }
+    return std::string_view::npos;
+}
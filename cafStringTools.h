@@ -18,21 +18,34 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include "cafFixedString.h"
+
 #include <boost/regex.hpp>
 
 #include <array>
 #include <cctype>
+#include <compare>
+#include <concepts>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <locale>
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <ranges>
 #include <regex>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #ifdef MSVC
 #pragma warning( disable : 4996 )
@@ -41,40 +54,326 @@
 namespace caffa::StringTools
 {
 /**
- * A fixed string class that is possible to use as a template parameter
+ * @brief The implementations available for substring search
  */
-template <std::size_t N>
-struct FixedString
+enum class SearchEngine
 {
-    std::array<char, N + 1> data{};
+    Scalar,
+    SSE2,
+    AVX2
+};
 
-    constexpr FixedString( const char* string ) noexcept { std::copy_n( string, N + 1, data.data() ); }
+/**
+ * @brief The fastest search engine supported by the CPU we are running on
+ */
+SearchEngine bestSearchEngine() noexcept;
 
-    constexpr operator std::string_view() const noexcept { return std::string_view( data.data(), N ); }
+/**
+ * @brief All search engines supported by the CPU we are running on, from slowest to fastest
+ */
+std::vector<SearchEngine> supportedSearchEngines();
 
-    constexpr auto size() const noexcept { return N; }
-};
+/**
+ * @brief Find the first occurrence of a needle in a haystack using the fastest supported search engine.
+ * Candidates are found by comparing the first and last byte of the needle at many positions at once,
+ * and only those are compared in full.
+ *
+ * @param haystack The text to search in
+ * @param needle The text to search for
+ * @param pos Position in the haystack to start searching from
+ * @return size_t The position of the needle or std::string_view::npos if not found
+ */
+size_t find( std::string_view haystack, std::string_view needle, size_t pos = 0u ) noexcept;
+
+/**
+ * @brief Find the first occurrence of a character in a text
+ *
+ * @param haystack The text to search in
+ * @param needle The character to search for
+ * @param pos Position in the haystack to start searching from
+ * @return size_t The position of the character or std::string_view::npos if not found
+ */
+size_t find( std::string_view haystack, char needle, size_t pos = 0u ) noexcept;
+
+/**
+ * @brief Find the first occurrence of a needle in a haystack using a specific search engine.
+ * Mostly useful for testing and benchmarking. The engine has to be supported by the CPU.
+ */
+size_t find( SearchEngine engine, std::string_view haystack, std::string_view needle, size_t pos = 0u ) noexcept;
 
-template <unsigned N>
-FixedString( char const ( & )[N] ) -> FixedString<N - 1>;
+/**
+ * @brief Anything that can be viewed as a string: std::string, std::string_view, const char* and FixedString
+ */
+template <typename T>
+concept StringLike = std::convertible_to<const T&, std::string_view>;
+
+/**
+ * @brief Append all strings covered by the iterators to an existing string with delimiters in between.
+ * The required size is computed up front when the iterators allow several passes, so the output grows at most once.
+ *
+ * @tparam InputIt A templated iterator type over string-like elements. Usually automatically deduced.
+ * @tparam Sentinel The type of the end, which does not have to be the iterator type
+ * @param out The string to append to
+ * @param first Start iterator
+ * @param last End iterator or sentinel
+ * @param delimiter String to join words with
+ * @return std::string& The output string
+ */
+template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    requires StringLike<std::iter_value_t<InputIt>>
+std::string& join_to( std::string& out, InputIt begin, Sentinel end, std::string_view delimiter )
+{
+    if constexpr ( std::forward_iterator<InputIt> )
+    {
+        size_t size  = 0u;
+        size_t count = 0u;
+        for ( auto it = begin; it != end; ++it, ++count )
+        {
+            size += std::string_view( *it ).size();
+        }
+        if ( count == 0u ) return out;
+        out.reserve( out.size() + size + ( count - 1u ) * delimiter.size() );
+    }
+
+    for ( bool first = true; begin != end; ++begin, first = false )
+    {
+        if ( !first ) out.append( delimiter );
+        out.append( std::string_view( *begin ) );
+    }
+    return out;
+}
+
+/**
+ * @brief Append all strings in a range to an existing string with delimiters in between
+ *
+ * @param out The string to append to
+ * @param range A range of string-like elements
+ * @param delimiter String to join words with
+ * @return std::string& The output string
+ */
+template <std::ranges::input_range Range>
+    requires StringLike<std::ranges::range_value_t<Range>>
+std::string& join_to( std::string& out, Range&& range, std::string_view delimiter )
+{
+    return join_to( out, std::ranges::begin( range ), std::ranges::end( range ), delimiter );
+}
 
 /**
  * @brief Join together all strings covered by the iterators with delimiters
  *
- * @tparam InputIt A templated iterator type. Usually automatically deduced.
+ * @tparam InputIt A templated iterator type over string-like elements. Usually automatically deduced.
+ * @tparam Sentinel The type of the end, which does not have to be the iterator type
  * @param first Start iterator
- * @param last End iterator
+ * @param last End iterator or sentinel
  * @param delimiter String to join words with
  * @return std::string One joined text string
  */
-template <class InputIt>
-std::string join( InputIt begin, InputIt end, const std::string& delimiter )
+template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    requires StringLike<std::iter_value_t<InputIt>>
+std::string join( InputIt begin, Sentinel end, std::string_view delimiter )
 {
-    if ( end == begin ) return std::string();
-    return std::accumulate( next( begin ), // there is at least 1 element, so OK.
-                            end,
-                            *begin, // the initial value
-                            [&delimiter]( auto a, auto b ) { return a + delimiter + b; } );
+    std::string output;
+    join_to( output, begin, end, delimiter );
+    return output;
+}
+
+/**
+ * @brief Join together all strings in a range with delimiters
+ *
+ * @param range A range of string-like elements
+ * @param delimiter String to join words with
+ * @return std::string One joined text string
+ */
+template <std::ranges::input_range Range>
+    requires StringLike<std::ranges::range_value_t<Range>>
+std::string join( Range&& range, std::string_view delimiter )
+{
+    std::string output;
+    join_to( output, std::ranges::begin( range ), std::ranges::end( range ), delimiter );
+    return output;
+}
+
+/**
+ * @brief A lazy range over the parts of a string separated by a delimiter.
+ * The parts are string_views into the original text, so nothing is copied or allocated,
+ * but the text has to outlive the range. Iterators do not refer back to the range itself, and begin()
+ * and end() have the same type so the range also works with algorithms and containers taking iterator pairs.
+ *
+ * @tparam Delimiter Either std::string_view or char
+ */
+template <typename Delimiter>
+class SplitView : public std::ranges::view_interface<SplitView<Delimiter>>
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_concept  = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::string_view*;
+        using reference         = std::string_view;
+
+        iterator() = default;
+        iterator( std::string_view text, Delimiter delimiter, bool skipEmptyParts )
+            : m_text( text )
+            , m_delimiter( delimiter )
+            , m_skipEmptyParts( skipEmptyParts )
+            , m_done( false )
+        {
+            findEnd();
+            skipEmpty();
+        }
+
+        std::string_view operator*() const noexcept { return m_text.substr( m_start, m_end - m_start ); }
+
+        iterator& operator++()
+        {
+            next();
+            skipEmpty();
+            return *this;
+        }
+
+        iterator operator++( int )
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==( const iterator& rhs ) const noexcept
+        {
+            return m_done == rhs.m_done && ( m_done || m_start == rhs.m_start );
+        }
+
+    private:
+        size_t length() const noexcept
+        {
+            if constexpr ( std::is_same_v<Delimiter, char> )
+                return 1u;
+            else
+                return m_delimiter.length();
+        }
+
+        void findEnd()
+        {
+            // An empty delimiter never matches, so the whole text is one part
+            auto pos = length() > 0u ? StringTools::find( m_text, m_delimiter, m_start ) : std::string_view::npos;
+            m_last   = pos == std::string_view::npos;
+            m_end    = m_last ? m_text.length() : pos;
+        }
+
+        void next()
+        {
+            if ( m_last )
+            {
+                m_done = true;
+                return;
+            }
+            m_start = m_end + length();
+            findEnd();
+        }
+
+        void skipEmpty()
+        {
+            while ( m_skipEmptyParts && !m_done && m_start == m_end )
+            {
+                next();
+            }
+        }
+
+    private:
+        std::string_view m_text;
+        Delimiter        m_delimiter{};
+        size_t           m_start          = 0u;
+        size_t           m_end            = 0u;
+        bool             m_skipEmptyParts = false;
+        bool             m_last           = true;
+        bool             m_done           = true;
+    };
+
+    SplitView() = default;
+    SplitView( std::string_view text, Delimiter delimiter, bool skipEmptyParts )
+        : m_text( text )
+        , m_delimiter( delimiter )
+        , m_skipEmptyParts( skipEmptyParts )
+    {
+    }
+
+    iterator begin() const { return iterator( m_text, m_delimiter, m_skipEmptyParts ); }
+    iterator end() const noexcept { return iterator(); }
+
+private:
+    std::string_view m_text;
+    Delimiter        m_delimiter{};
+    bool             m_skipEmptyParts = false;
+};
+
+/**
+ * @brief Lazily split text string by a given delimiter without copying
+ *
+ * @param string The text string to split. Has to outlive the returned view.
+ * @param delimiter String to split on
+ * @param skipEmptyParts If true will drop any empty entry
+ * @return A forward range of string_views
+ */
+inline SplitView<std::string_view>
+    split_view( std::string_view string, std::string_view delimiter, bool skipEmptyParts = false )
+{
+    return SplitView<std::string_view>( string, delimiter, skipEmptyParts );
+}
+
+/**
+ * @brief Lazily split text string by a single character without copying
+ *
+ * @param string The text string to split. Has to outlive the returned view.
+ * @param delimiter Character to split on
+ * @param skipEmptyParts If true will drop any empty entry
+ * @return A forward range of string_views
+ */
+inline SplitView<char> split_view( std::string_view string, char delimiter, bool skipEmptyParts = false )
+{
+    return SplitView<char>( string, delimiter, skipEmptyParts );
+}
+
+/**
+ * @brief Split text string into an existing container, reusing its capacity.
+ * Existing elements are assigned to in place, so a std::vector<std::string> keeps both its own
+ * storage and the storage of each string. Left-over elements are erased.
+ *
+ * @tparam Container A container of std::string or std::string_view
+ * @param output The container to fill
+ * @param string The text string to split
+ * @param delimiter String or character to split on
+ * @param skipEmptyParts If true will drop any empty entry
+ * @return Container& The output container
+ */
+template <class Container, typename Delimiter>
+    requires std::assignable_from<typename Container::value_type&, std::string_view> &&
+             ( std::is_same_v<Delimiter, char> || std::is_convertible_v<Delimiter, std::string_view> )
+Container& split_into( Container&       output,
+                       std::string_view string,
+                       const Delimiter& delimiter,
+                       bool             skipEmptyParts = false )
+{
+    auto existing  = output.begin();
+    bool appending = existing == output.end();
+    for ( auto token : split_view( string, delimiter, skipEmptyParts ) )
+    {
+        if ( appending )
+        {
+            output.emplace_back( token );
+            continue;
+        }
+        *existing = token;
+        appending = ++existing == output.end();
+    }
+    if ( !appending )
+    {
+        output.erase( existing, output.end() );
+    }
+    return output;
 }
 
 /**
@@ -83,6 +382,7 @@ std::string join( InputIt begin, InputIt end, const std::string& delimiter )
  * @tparam Container the type of string container to create
  * @param string The text string to split
  * @param delimiter String to split on
+ * @param skipEmptyParts If true will drop any empty entry
  * @return A container of strings
  */
 template <class Container = std::list<std::string>>
@@ -91,27 +391,104 @@ Container split( const std::string& string, const std::string& delimiter, bool s
     static_assert( std::is_same<typename Container::value_type, std::string>::value,
                    "split() only creates containers of std::strings" );
     Container output;
+    for ( auto token : split_view( string, delimiter, skipEmptyParts ) )
+    {
+        output.emplace_back( token );
+    }
+    return output;
+}
 
-    size_t start = 0u;
-    size_t end   = string.find( delimiter );
-    while ( true )
+/**
+ * @brief A compiled regular expression that knows which characters its matches have to contain.
+ * Searching jumps between those required characters with a fast scan and only runs the regex engine anchored
+ * at the few positions in front of each of them where a match could start. Only the start of each alternative
+ * up to its first required character is analysed, so anything after that, groups included, is left to the
+ * engine. Patterns where it cannot be worked out (groups or anchors in front of the first required character,
+ * patterns that can match nothing...) are searched with the regex engine alone.
+ */
+class CompiledRegex
+{
+public:
+    /**
+     * @brief Get a compiled regular expression from a process wide cache, compiling it on first use.
+     * The cache is thread safe. Throws boost::regex_error if the pattern is invalid.
+     *
+     * @param pattern The regular expression
+     * @param flags Boost regex syntax flags
+     */
+    static std::shared_ptr<const CompiledRegex> get( std::string_view        pattern,
+                                                     boost::regex::flag_type flags = boost::regex::normal );
+
+    explicit CompiledRegex( std::string_view pattern, boost::regex::flag_type flags = boost::regex::normal );
+
+    const boost::regex& regex() const noexcept { return m_regex; }
+    bool                hasPrefilter() const noexcept { return m_requiredCharacterCount > 0u; }
+
+    /**
+     * @brief Find the leftmost match starting at or after a position
+     *
+     * @param text The text to search in
+     * @param pos The position to start at
+     * @return The start position and length of the match. The start is std::string_view::npos if there is no match.
+     */
+    std::pair<size_t, size_t> search( std::string_view text, size_t pos = 0u ) const;
+
+private:
+    size_t nextRequired( std::string_view text, size_t pos ) const noexcept;
+
+    boost::regex          m_regex;
+    std::array<bool, 256> m_prefixCharacters{};
+    std::array<bool, 256> m_requiredCharacters{};
+    size_t                m_requiredCharacterCount = 0u;
+    char                  m_requiredCharacter      = '\0';
+};
+
+/**
+ * @brief Split text string by the matches of a compiled regular expression
+ *
+ * @tparam Container the type of string container to create
+ * @param string The text string to split
+ * @param regex the compiled regular expression
+ * @param skipEmptyParts If true will drop any empty entry
+ * @return A container of strings
+ */
+template <class Container = std::list<std::string>>
+Container split( std::string_view string, const CompiledRegex& regex, const bool skipEmptyParts = false )
+{
+    static_assert( std::is_same<typename Container::value_type, std::string>::value,
+                   "split() only creates containers of std::strings" );
+
+    Container output;
+    if ( !regex.hasPrefilter() )
     {
-        auto token = string.substr( start, end - start );
-        if ( !skipEmptyParts || token.length() > 0u )
+        boost::cregex_token_iterator it( string.data(), string.data() + string.size(), regex.regex(), -1 );
+        boost::cregex_token_iterator end;
+
+        while ( it != end )
         {
-            output.push_back( token );
+            auto token = *it++;
+            if ( !skipEmptyParts || token.length() > 0u ) output.push_back( token );
         }
-        if ( end == std::string::npos ) break;
+        return output;
+    }
 
-        start = end + delimiter.length();
-        end   = string.find( delimiter, start );
+    // Same parts as the token iterator above: no empty part after a match at the very end
+    size_t start = 0u;
+    for ( auto [pos, length] = regex.search( string ); pos != std::string_view::npos;
+          std::tie( pos, length ) = regex.search( string, start ) )
+    {
+        if ( !skipEmptyParts || pos > start ) output.emplace_back( string.substr( start, pos - start ) );
+        start = pos + length;
     }
+    if ( start < string.size() ) output.emplace_back( string.substr( start ) );
 
     return output;
 }
 
 /**
  * @brief Split text string by regex tokens
+ * Deliberately tokenises with the given regex and no prefilter: going through the CompiledRegex cache would
+ * hash the pattern and possibly compile it again on every call. Keep a CompiledRegex for prefiltered splits.
  *
  * @tparam Container the type of string container to create
  * @param string The text string to split
@@ -139,6 +516,25 @@ Container split( const std::string& string, const boost::regex& regex, const boo
     return output;
 }
 
+/**
+ * @brief Split text string by a regular expression pattern, compiling it only once per process
+ *
+ * @tparam Container the type of string container to create
+ * @param string The text string to split
+ * @param pattern the regular expression
+ * @param skipEmptyParts If true will drop any empty entry
+ * @param flags Boost regex syntax flags
+ * @return A container of strings
+ */
+template <class Container = std::list<std::string>>
+Container splitRegex( std::string_view        string,
+                      std::string_view        pattern,
+                      const bool              skipEmptyParts = false,
+                      boost::regex::flag_type flags          = boost::regex::normal )
+{
+    return split<Container>( string, *CompiledRegex::get( pattern, flags ), skipEmptyParts );
+}
+
 /**
  * @brief Trim away white-space at start and end of string
  *
@@ -147,6 +543,14 @@ Container split( const std::string& string, const boost::regex& regex, const boo
  */
 std::string trim( std::string s );
 
+/**
+ * @brief Trim away ASCII white-space at start and end of a string without copying
+ *
+ * @param s string
+ * @return std::string_view A view into s
+ */
+std::string_view trim_view( std::string_view s ) noexcept;
+
 /**
  * @brief Turn string to lower case
  *
@@ -155,6 +559,80 @@ std::string trim( std::string s );
  */
 std::string tolower( std::string data );
 
+/**
+ * @brief Turn string to upper case
+ *
+ * @param s string
+ * @return std::string
+ */
+std::string toupper( std::string data );
+
+/**
+ * @brief Turn ASCII letters to lower case in place, 16 characters at a time. Other bytes are left alone.
+ *
+ * @param data The characters to change
+ */
+void tolower_in_place( std::span<char> data ) noexcept;
+
+/**
+ * @brief Turn ASCII letters to upper case in place, 16 characters at a time. Other bytes are left alone.
+ *
+ * @param data The characters to change
+ */
+void toupper_in_place( std::span<char> data ) noexcept;
+
+/**
+ * @brief Compare two strings for equality ignoring ASCII case
+ */
+bool iequals( std::string_view lhs, std::string_view rhs ) noexcept;
+
+/**
+ * @brief Compare two strings ignoring ASCII case, ordering them like their lower case versions
+ */
+std::weak_ordering icompare( std::string_view lhs, std::string_view rhs ) noexcept;
+
+/**
+ * @brief Find the first occurrence of a needle in a haystack ignoring ASCII case
+ *
+ * @param haystack The text to search in
+ * @param needle The text to search for
+ * @param pos Position in the haystack to start searching from
+ * @return size_t The position of the needle or std::string_view::npos if not found
+ */
+size_t ifind( std::string_view haystack, std::string_view needle, size_t pos = 0u ) noexcept;
+
+/**
+ * @brief Hash a string ignoring ASCII case, so strings that are iequals() hash the same
+ */
+size_t ihash( std::string_view s ) noexcept;
+
+/**
+ * @brief Case insensitive hash for unordered containers. Transparent, so lookups with string_views do not allocate.
+ */
+struct CaseInsensitiveHash
+{
+    using is_transparent = void;
+    size_t operator()( std::string_view s ) const noexcept { return ihash( s ); }
+};
+
+/**
+ * @brief Case insensitive equality for unordered containers
+ */
+struct CaseInsensitiveEqual
+{
+    using is_transparent = void;
+    bool operator()( std::string_view lhs, std::string_view rhs ) const noexcept { return iequals( lhs, rhs ); }
+};
+
+/**
+ * @brief Case insensitive ordering for ordered containers
+ */
+struct CaseInsensitiveLess
+{
+    using is_transparent = void;
+    bool operator()( std::string_view lhs, std::string_view rhs ) const noexcept { return icompare( lhs, rhs ) < 0; }
+};
+
 /**
  * @brief Replace a portion of a string with something else
  * @param data The full string to replace in
@@ -164,6 +642,75 @@ std::string tolower( std::string data );
  */
 std::string replace( const std::string& data, const std::string& replace, const std::string& with );
 
+/**
+ * @brief Replace any number of patterns in a single pass over the text.
+ * The patterns are compiled into an Aho-Corasick automaton once, so reuse the object for every text.
+ * Where patterns overlap the leftmost match wins, and the longest one of those starting at the same position.
+ * The replaced text is not searched again.
+ */
+class MultiReplace
+{
+public:
+    using Replacements = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @brief Compile a set of replacements. If the same pattern is given twice, the last replacement wins.
+     * Throws std::invalid_argument if a pattern is empty.
+     *
+     * @param replacements Pairs of what to replace and what to replace it with
+     */
+    explicit MultiReplace( const Replacements& replacements );
+    explicit MultiReplace( std::initializer_list<Replacements::value_type> replacements )
+        : MultiReplace( Replacements( replacements ) )
+    {
+    }
+
+    /**
+     * @brief Replace all patterns in a text
+     *
+     * @param text The text to replace in
+     * @return std::string A copy with the replaced parts
+     */
+    std::string apply( std::string_view text ) const;
+
+    /**
+     * @brief Replace all patterns in a text and append the result to a string
+     *
+     * @param out The string to append to
+     * @param text The text to replace in
+     * @return std::string& The output string
+     */
+    std::string& apply_to( std::string& out, std::string_view text ) const;
+
+private:
+    uint32_t next( uint32_t state, char c ) const noexcept
+    {
+        return m_transitions[state * m_classCount + m_byteClasses[static_cast<unsigned char>( c )]];
+    }
+
+    std::array<uint16_t, 256> m_byteClasses{};
+    size_t                    m_classCount = 1u;
+    std::vector<uint32_t>     m_transitions;
+    std::vector<uint32_t>     m_depths;
+    std::vector<int32_t>      m_outputs;
+    std::vector<size_t>       m_patternLengths;
+    std::vector<std::string>  m_with;
+
+    std::array<bool, 256> m_startsPattern{};
+    size_t                m_startCount = 0u;
+    char                  m_startByte  = '\0';
+};
+
+/**
+ * @brief Replace any number of patterns in a single pass. Compiles the patterns for every call,
+ * so use MultiReplace directly when doing the same replacements many times.
+ *
+ * @param data The full string to replace in
+ * @param replacements Pairs of what to replace and what to replace it with
+ * @return Returns a copy with the replaced parts
+ */
+std::string replace_many( std::string_view data, const MultiReplace::Replacements& replacements );
+
 /**
  * @brief Create a formatted string from any nunber of arguments
  *
@@ -206,6 +753,11 @@ constexpr bool isdigit( int c ) noexcept
     return c >= '0' && c <= '9';
 }
 
+constexpr bool isspace( char c ) noexcept
+{
+    return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
 /**
  * Convert a string to an int64 with fail checking
  * @param string A string to convert
@@ -235,3 +787,7 @@ std::optional<uint32_t> toUint32( const std::string& string );
 std::optional<double> toDouble( const std::string& string );
 
 } // namespace caffa::StringTools
+
+// The split view only holds string_views, so its iterators stay valid after the view itself is gone
+template <typename Delimiter>
+inline constexpr bool std::ranges::enable_borrowed_range<caffa::StringTools::SplitView<Delimiter>> = true;
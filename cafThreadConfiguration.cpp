@@ -0,0 +1,97 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafThreadConfiguration.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace caffa;
+
+#ifdef __linux__
+namespace
+{
+bool applyToHandle( const ThreadConfiguration& configuration, pthread_t handle )
+{
+    bool success = true;
+    if ( !configuration.cpus.empty() )
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        for ( auto cpu : configuration.cpus )
+        {
+            // CPU_SET does not check the bounds of the set
+            if ( cpu >= CPU_SETSIZE )
+            {
+                success = false;
+                continue;
+            }
+            CPU_SET( cpu, &cpuSet );
+        }
+        if ( CPU_COUNT( &cpuSet ) > 0 )
+        {
+            success = pthread_setaffinity_np( handle, sizeof( cpuSet ), &cpuSet ) == 0 && success;
+        }
+    }
+    if ( configuration.schedulingPolicy )
+    {
+        sched_param parameters{};
+        parameters.sched_priority = configuration.schedulingPriority;
+        success = pthread_setschedparam( handle, *configuration.schedulingPolicy, &parameters ) == 0 && success;
+    }
+    return success;
+}
+} // namespace
+#endif
+
+bool ThreadConfiguration::empty() const
+{
+    return cpus.empty() && !schedulingPolicy && !niceLevel;
+}
+
+bool ThreadConfiguration::applyToCurrentThread() const
+{
+#ifdef __linux__
+    bool success = applyToHandle( *this, pthread_self() );
+    if ( niceLevel )
+    {
+        // On Linux the nice value is a property of each thread rather than the process
+        success = setpriority( PRIO_PROCESS, static_cast<id_t>( syscall( SYS_gettid ) ), *niceLevel ) == 0 && success;
+    }
+    return success;
+#else
+    return empty();
+#endif
+}
+
+bool ThreadConfiguration::applyToThread( std::thread& thread ) const
+{
+#ifdef __linux__
+    return applyToHandle( *this, thread.native_handle() );
+#else
+    return empty();
+#endif
+}
@@ -0,0 +1,59 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace caffa
+{
+/**
+ * Placement and scheduling of a background thread.
+ * Unset members leave the corresponding property of the thread alone.
+ * Only supported on Linux. On other platforms applying a configuration does nothing.
+ */
+struct ThreadConfiguration
+{
+    std::vector<unsigned> cpus;                   ///< Cores the thread may run on. Empty means no pinning.
+                                                  ///< Cores beyond CPU_SETSIZE are an error and left out.
+    std::optional<int>    schedulingPolicy;       ///< SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR
+    int                   schedulingPriority = 0; ///< Static priority for the real-time policies
+    std::optional<int>    niceLevel;
+
+    bool empty() const;
+
+    /**
+     * Apply to the calling thread. Should be done by a thread before it allocates its working memory,
+     * so the memory gets placed on the NUMA node of the chosen cores.
+     * @return false if any part of the configuration could not be applied
+     */
+    bool applyToCurrentThread() const;
+
+    /**
+     * Apply to another thread. The nice level can only be set from the thread itself and is ignored here.
+     * @return false if any part of the configuration could not be applied
+     */
+    bool applyToThread( std::thread& thread ) const;
+};
+
+} // namespace caffa
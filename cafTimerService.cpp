@@ -0,0 +1,347 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafTimerService.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace caffa;
+
+namespace
+{
+class Service
+{
+public:
+    static Service& instance()
+    {
+        // Never destroyed, so timers can still be cancelled from static destructors. The thread is stopped at exit
+        // before any static created ahead of the service is destroyed, as those may be used by the tasks.
+        static Service* service = []()
+        {
+            auto service = new Service;
+            std::atexit( []() { instance().shutdown(); } );
+            return service;
+        }();
+        return *service;
+    }
+
+    TimerService::TimerId
+        add( std::chrono::milliseconds delay, std::chrono::milliseconds interval, TimerService::Task task )
+    {
+        std::scoped_lock lock( m_mutex );
+        if ( !m_thread.joinable() && !m_stopping )
+        {
+            m_thread = std::thread( &Service::run, this );
+        }
+
+        auto id      = m_nextId++;
+        auto expiry  = dueTick( delay );
+        m_timers[id] = { expiry,
+                         static_cast<uint64_t>( std::max<int64_t>( interval.count(), 0 ) ),
+                         std::make_shared<TimerService::Task>( std::move( task ) ) };
+        insert( id, expiry );
+        m_changed.notify_one();
+        return id;
+    }
+
+    bool reschedule( TimerService::TimerId id, std::chrono::milliseconds delay )
+    {
+        std::scoped_lock lock( m_mutex );
+        auto             it = m_timers.find( id );
+        if ( it == m_timers.end() ) return false;
+
+        // The entry in the old slot is left behind and skipped when reached, as its expiry no longer matches
+        it->second.expiry = dueTick( delay );
+        insert( id, it->second.expiry );
+        m_changed.notify_one();
+        return true;
+    }
+
+    bool cancel( TimerService::TimerId id )
+    {
+        std::unique_lock lock( m_mutex );
+        bool             cancelled = m_timers.erase( id ) > 0u;
+        if ( std::this_thread::get_id() != m_thread.get_id() )
+        {
+            m_runFinished.wait( lock, [this, id]() { return m_running != id; } );
+        }
+        return cancelled;
+    }
+
+    size_t pending()
+    {
+        std::scoped_lock lock( m_mutex );
+        return m_timers.size();
+    }
+
+    bool setThreadConfiguration( const ThreadConfiguration& configuration )
+    {
+        std::scoped_lock lock( m_mutex );
+        m_configuration = configuration;
+        return !m_thread.joinable() || configuration.applyToThread( m_thread );
+    }
+
+private:
+    static constexpr unsigned LEVEL_BITS = 6u;
+    static constexpr size_t   SLOTS      = size_t( 1u ) << LEVEL_BITS;
+    static constexpr size_t   LEVELS     = 4u;
+
+    struct Timer
+    {
+        uint64_t                            expiry;
+        uint64_t                            interval;
+        std::shared_ptr<TimerService::Task> task;
+    };
+
+    struct Entry
+    {
+        TimerService::TimerId id;
+        uint64_t              expiry;
+    };
+
+    Service()
+        : m_start( std::chrono::steady_clock::now() )
+    {
+    }
+
+    uint64_t currentTick() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::milliseconds>( elapsed ).count() );
+    }
+
+    uint64_t dueTick( std::chrono::milliseconds delay ) const
+    {
+        return std::max( currentTick() + static_cast<uint64_t>( std::max<int64_t>( delay.count(), 0 ) ), m_now + 1u );
+    }
+
+    /**
+     * Put the entry on the lowest level where it falls within the 64 slots ahead of the current one.
+     * Entries further out than the top level covers go in its last slot and are put back when it is spread out.
+     */
+    void insert( TimerService::TimerId id, uint64_t expiry )
+    {
+        for ( size_t level = 0; level < LEVELS; ++level )
+        {
+            auto shift = static_cast<unsigned>( level * LEVEL_BITS );
+            auto block = expiry >> shift;
+            auto now   = m_now >> shift;
+            if ( block - now < SLOTS || level + 1u == LEVELS )
+            {
+                auto slot = std::min( block, now + SLOTS - 1u ) & ( SLOTS - 1u );
+                m_slots[level][slot].push_back( { id, expiry } );
+                m_occupied[level] |= uint64_t( 1u ) << slot;
+                return;
+            }
+        }
+    }
+
+    bool isCurrent( const Entry& entry ) const
+    {
+        auto it = m_timers.find( entry.id );
+        return it != m_timers.end() && it->second.expiry == entry.expiry;
+    }
+
+    /**
+     * The first tick at which a timer is due or an occupied slot of a higher level has to be spread out
+     */
+    std::optional<uint64_t> nextEvent() const
+    {
+        std::optional<uint64_t> next;
+        for ( size_t level = 0; level < LEVELS; ++level )
+        {
+            if ( !m_occupied[level] ) continue;
+
+            auto shift    = static_cast<unsigned>( level * LEVEL_BITS );
+            auto block    = m_now >> shift;
+            auto after    = static_cast<int>( ( block + 1u ) & ( SLOTS - 1u ) );
+            auto distance = static_cast<uint64_t>( std::countr_zero( std::rotr( m_occupied[level], after ) ) ) + 1u;
+            auto tick     = ( block + distance ) << shift;
+            if ( !next || tick < *next ) next = tick;
+        }
+        return next;
+    }
+
+    /**
+     * Step through the ticks where something happens up to the given tick, collecting the entries that are due
+     */
+    void advanceTo( uint64_t tick, std::vector<Entry>& due )
+    {
+        for ( auto next = nextEvent(); next && *next <= tick; next = nextEvent() )
+        {
+            m_now = *next;
+            for ( size_t level = LEVELS - 1u; level > 0u; --level )
+            {
+                auto shift = static_cast<unsigned>( level * LEVEL_BITS );
+                if ( m_now & ( ( uint64_t( 1u ) << shift ) - 1u ) ) continue;
+
+                for ( const auto& entry : takeSlot( level, ( m_now >> shift ) & ( SLOTS - 1u ) ) )
+                {
+                    if ( !isCurrent( entry ) ) continue;
+
+                    if ( entry.expiry <= m_now )
+                        due.push_back( entry );
+                    else
+                        insert( entry.id, entry.expiry );
+                }
+            }
+            for ( const auto& entry : takeSlot( 0u, m_now & ( SLOTS - 1u ) ) )
+            {
+                if ( isCurrent( entry ) ) due.push_back( entry );
+            }
+        }
+        m_now = std::max( m_now, tick );
+    }
+
+    std::vector<Entry> takeSlot( size_t level, uint64_t slot )
+    {
+        m_occupied[level] &= ~( uint64_t( 1u ) << slot );
+        return std::exchange( m_slots[level][slot], {} );
+    }
+
+    void run()
+    {
+        ThreadConfiguration configuration;
+        {
+            std::scoped_lock lock( m_mutex );
+            configuration = m_configuration;
+        }
+        configuration.applyToCurrentThread();
+
+        std::vector<Entry> due;
+        std::unique_lock   lock( m_mutex );
+        while ( !m_stopping )
+        {
+            due.clear();
+            advanceTo( currentTick(), due );
+            for ( const auto& entry : due )
+            {
+                // An earlier task may have cancelled or rescheduled this one
+                if ( m_stopping || !isCurrent( entry ) ) continue;
+
+                auto& timer = m_timers[entry.id];
+                auto  task  = timer.task;
+                if ( timer.interval > 0u )
+                {
+                    auto missed  = ( m_now - timer.expiry ) / timer.interval;
+                    timer.expiry = timer.expiry + ( missed + 1u ) * timer.interval;
+                    insert( entry.id, timer.expiry );
+                }
+                else
+                {
+                    m_timers.erase( entry.id );
+                }
+
+                m_running = entry.id;
+                lock.unlock();
+                try
+                {
+                    ( *task )();
+                }
+                catch ( const std::exception& e )
+                {
+                    std::fprintf( stderr, "[*** LOG ERROR in TimerService ***] %s\n", e.what() );
+                }
+                lock.lock();
+                m_running = 0u;
+                m_runFinished.notify_all();
+            }
+            if ( m_stopping ) break;
+
+            if ( auto next = nextEvent(); next )
+            {
+                m_changed.wait_until( lock, m_start + std::chrono::milliseconds( *next ) );
+            }
+            else
+            {
+                m_changed.wait( lock );
+            }
+        }
+    }
+
+    void shutdown()
+    {
+        {
+            std::scoped_lock lock( m_mutex );
+            m_stopping = true;
+        }
+        m_changed.notify_one();
+        if ( m_thread.joinable() ) m_thread.join();
+    }
+
+    std::mutex                                                m_mutex;
+    std::condition_variable                                   m_changed;
+    std::condition_variable                                   m_runFinished;
+    std::unordered_map<TimerService::TimerId, Timer>          m_timers;
+    std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> m_slots;
+    std::array<uint64_t, LEVELS>                              m_occupied{};
+    uint64_t                                                  m_now      = 0u;
+    TimerService::TimerId                                     m_nextId   = 1u;
+    TimerService::TimerId                                     m_running  = 0u;
+    bool                                                      m_stopping = false;
+    ThreadConfiguration                                       m_configuration;
+    const std::chrono::steady_clock::time_point               m_start;
+    std::thread                                               m_thread;
+};
+
+} // namespace
+
+TimerService::TimerId TimerService::schedule( std::chrono::milliseconds delay, Task task )
+{
+    return Service::instance().add( delay, std::chrono::milliseconds( 0 ), std::move( task ) );
+}
+
+TimerService::TimerId TimerService::scheduleRepeating( std::chrono::milliseconds interval, Task task )
+{
+    return Service::instance().add( interval, std::max( interval, std::chrono::milliseconds( 1 ) ), std::move( task ) );
+}
+
+bool TimerService::reschedule( TimerId timer, std::chrono::milliseconds delay )
+{
+    return Service::instance().reschedule( timer, delay );
+}
+
+bool TimerService::cancel( TimerId timer )
+{
+    return Service::instance().cancel( timer );
+}
+
+size_t TimerService::pendingTimers()
+{
+    return Service::instance().pending();
+}
+
+bool TimerService::setThreadConfiguration( const ThreadConfiguration& configuration )
+{
+    return Service::instance().setThreadConfiguration( configuration );
+}
@@ -0,0 +1,81 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include "cafThreadConfiguration.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace caffa
+{
+/**
+ * One background thread running all periodic and delayed work of the library, such as the periodic log flush,
+ * the trace exporter and metrics file writing, instead of a sleeping thread for each.
+ *
+ * Timers are kept in a hierarchical timer wheel with millisecond ticks: four levels of 64 slots, each level
+ * covering 64 times the span of the one below. Scheduling and cancelling are constant time, and the thread only
+ * wakes up when a timer is due or a slot of a higher level has to be spread out over the levels below.
+ *
+ * Tasks run one at a time on the timer thread and should be short. A slow task delays the other timers.
+ */
+class TimerService
+{
+public:
+    using TimerId = uint64_t;
+    using Task    = std::function<void()>;
+
+    /**
+     * Run the task once after the delay
+     */
+    static TimerId schedule( std::chrono::milliseconds delay, Task task );
+
+    /**
+     * Run the task every interval, starting one interval from now. Runs are spaced from when they were due rather
+     * than from when they finished, so the timer does not drift. Runs missed while the thread was busy are skipped.
+     */
+    static TimerId scheduleRepeating( std::chrono::milliseconds interval, Task task );
+
+    /**
+     * Move the next run of a timer to the given delay from now. Repeating timers keep their interval after that.
+     * @return false if the timer has already run or been cancelled
+     */
+    static bool reschedule( TimerId timer, std::chrono::milliseconds delay );
+
+    /**
+     * Cancel a timer. When called from another thread than the timer thread it waits for a run in progress to
+     * finish, so the task is guaranteed not to be running or to run again once this returns.
+     * @return false if the timer had already run or been cancelled
+     */
+    static bool cancel( TimerId timer );
+
+    static size_t pendingTimers();
+
+    /**
+     * Configure the timer thread. Applied right away if the thread is running, otherwise when it starts.
+     * @return false if the configuration could not be applied to the running thread
+     */
+    static bool setThreadConfiguration( const ThreadConfiguration& configuration );
+};
+
+} // namespace caffa
@@ -0,0 +1,378 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#include "cafTracing.h"
+
+#include "cafLogger.h"
+#include "cafTimerService.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define CAFFA_TRACING_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace caffa;
+
+namespace
+{
+uint64_t steadyNanoseconds()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+/**
+ * Single producer, single consumer ring of spans. Written by the owning thread and drained by the exporter.
+ */
+struct ThreadBuffer
+{
+    static constexpr size_t Capacity = 16384u;
+
+    explicit ThreadBuffer( uint32_t index )
+        : threadIndex( index )
+        , spans( std::make_unique<Tracing::Span[]>( Capacity ) )
+    {
+    }
+
+    uint32_t                         threadIndex;
+    std::unique_ptr<Tracing::Span[]> spans;
+    std::atomic<size_t>              head       = 0u;
+    std::atomic<size_t>              tail       = 0u;
+    size_t                           cachedTail = 0u; ///< The producer's last view of tail
+    std::atomic<size_t>              dropped    = 0u;
+    std::atomic<bool>                retired    = false;
+};
+
+struct ThreadBufferHolder
+{
+    ~ThreadBufferHolder();
+    std::shared_ptr<ThreadBuffer> buffer;
+};
+
+// Spans that could not be put in a buffer of their thread
+std::atomic<size_t> s_droppedWithoutBuffer = 0u;
+
+class Exporter
+{
+public:
+    static Exporter& instance()
+    {
+        static Exporter exporter;
+        return exporter;
+    }
+
+    std::shared_ptr<ThreadBuffer> registerThread()
+    {
+        std::scoped_lock lock( m_buffersMutex );
+        auto             buffer = std::make_shared<ThreadBuffer>( m_nextThreadIndex++ );
+        m_buffers.push_back( buffer );
+        return buffer;
+    }
+
+    bool start( const std::string& outputFile, std::chrono::milliseconds exportInterval )
+    {
+        std::scoped_lock controlLock( m_controlMutex );
+        stopExport();
+
+        std::scoped_lock lock( m_fileMutex );
+        m_file.open( outputFile, std::ios::out | std::ios::trunc );
+        if ( !m_file )
+        {
+            CAFFA_ERROR( "Could not open trace file " << outputFile );
+            return false;
+        }
+        m_file << "{\"traceEvents\":[";
+        // The start time is taken first, so spans recorded after the discard end after it
+        m_startTime   = Tracing::now();
+        m_startTimeNs = steadyNanoseconds();
+        m_nsPerTick   = 1.0;
+        m_firstEvent  = true;
+        discard();
+        m_timer       = TimerService::scheduleRepeating( exportInterval, [this]() { exportSpans(); } );
+        return true;
+    }
+
+    void stop()
+    {
+        std::scoped_lock controlLock( m_controlMutex );
+        stopExport();
+    }
+
+    /**
+     * Called when the thread of a buffer exits. Outside a session nothing will drain the buffer, so it goes at once.
+     */
+    void retire( const std::shared_ptr<ThreadBuffer>& buffer )
+    {
+        std::scoped_lock lock( m_buffersMutex );
+        buffer->retired = true;
+        if ( !m_sessionActive )
+        {
+            m_droppedFromRetired += buffer->dropped;
+            std::erase( m_buffers, buffer );
+        }
+    }
+
+    size_t dropped()
+    {
+        std::scoped_lock lock( m_buffersMutex );
+        size_t           dropped = m_droppedFromRetired + s_droppedWithoutBuffer.load( std::memory_order_relaxed );
+        for ( const auto& buffer : m_buffers )
+        {
+            dropped += buffer->dropped;
+        }
+        return dropped;
+    }
+
+private:
+    ~Exporter() { stop(); }
+
+    void stopExport()
+    {
+        uint64_t timer = 0u;
+        {
+            std::scoped_lock lock( m_fileMutex );
+            timer = std::exchange( m_timer, 0u );
+        }
+        if ( !timer ) return;
+
+        // Not under the file mutex, as cancelling waits for an export in progress
+        TimerService::cancel( timer );
+
+        std::scoped_lock lock( m_fileMutex );
+        drain();
+        m_file << "]}\n";
+        m_file.close();
+
+        std::scoped_lock buffersLock( m_buffersMutex );
+        m_sessionActive = false;
+    }
+
+    void exportSpans()
+    {
+        std::scoped_lock lock( m_fileMutex );
+        drain();
+        m_file.flush();
+    }
+
+    void drain()
+    {
+#ifdef CAFFA_TRACING_USE_TSC
+        // Calibrate the time stamp counter against the steady clock over the whole session so far
+        if ( auto ticks = Tracing::now() - m_startTime; ticks > 0u )
+        {
+            m_nsPerTick = static_cast<double>( steadyNanoseconds() - m_startTimeNs ) / ticks;
+        }
+#endif
+        std::scoped_lock lock( m_buffersMutex );
+        for ( auto it = m_buffers.begin(); it != m_buffers.end(); )
+        {
+            auto& buffer  = **it;
+            bool  retired = buffer.retired;
+
+            size_t tail = buffer.tail.load( std::memory_order_relaxed );
+            size_t head = buffer.head.load( std::memory_order_acquire );
+            for ( ; tail != head; ++tail )
+            {
+                write( buffer.threadIndex, buffer.spans[tail % ThreadBuffer::Capacity] );
+            }
+            buffer.tail.store( tail, std::memory_order_release );
+
+            if ( retired )
+            {
+                m_droppedFromRetired += buffer.dropped;
+                it = m_buffers.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * Throw away spans left over from an earlier session
+     */
+    void discard()
+    {
+        std::scoped_lock lock( m_buffersMutex );
+        for ( const auto& buffer : m_buffers )
+        {
+            buffer->tail.store( buffer->head.load( std::memory_order_acquire ), std::memory_order_release );
+        }
+        m_sessionActive = true;
+    }
+
+    void write( uint32_t threadIndex, const Tracing::Span& span )
+    {
+        // Left over from before the session
+        if ( span.end <= m_startTime ) return;
+
+        // Spans that started before the session are clamped to its start
+        auto begin    = ( std::max( span.begin, m_startTime ) - m_startTime ) * m_nsPerTick;
+        auto duration = ( span.end - std::max( span.begin, m_startTime ) ) * m_nsPerTick;
+
+        char timing[96];
+        std::snprintf( timing,
+                       sizeof( timing ),
+                       "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+                       begin / 1000.0,
+                       duration / 1000.0,
+                       threadIndex );
+
+        m_file << ( m_firstEvent ? "\n" : ",\n" ) << "{\"name\":";
+        writeString( span.name );
+        m_file << ",\"ph\":\"X\"," << timing;
+        if ( span.argumentName )
+        {
+            m_file << ",\"args\":{";
+            writeString( span.argumentName );
+            m_file << ":" << span.argumentValue << "}";
+        }
+        m_file << "}";
+        m_firstEvent = false;
+    }
+
+    void writeString( const char* text )
+    {
+        m_file << '"';
+        for ( const char* c = text; *c; ++c )
+        {
+            if ( *c == '"' || *c == '\\' )
+            {
+                m_file << '\\' << *c;
+            }
+            else if ( static_cast<unsigned char>( *c ) >= 0x20 )
+            {
+                m_file << *c;
+            }
+        }
+        m_file << '"';
+    }
+
+    std::mutex                                 m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    uint32_t                                   m_nextThreadIndex    = 1u;
+    size_t                                     m_droppedFromRetired = 0u;
+    bool                                       m_sessionActive      = false;
+
+    std::mutex    m_controlMutex; ///< Serialises starting and stopping
+    std::mutex    m_fileMutex;
+    std::ofstream m_file;
+    bool          m_firstEvent  = true;
+    uint64_t      m_startTime   = 0u;
+    uint64_t      m_startTimeNs = 0u;
+    double        m_nsPerTick   = 1.0;
+    uint64_t      m_timer       = 0u;
+};
+
+// Kept apart from the holder so the hot path avoids the guard of a thread_local with a destructor
+thread_local ThreadBuffer* t_threadBuffer = nullptr;
+// Set once the holder is gone, so spans recorded by later thread_local destructors are dropped
+thread_local bool t_threadBufferReleased = false;
+
+ThreadBufferHolder::~ThreadBufferHolder()
+{
+    t_threadBuffer         = nullptr;
+    t_threadBufferReleased = true;
+    if ( buffer ) Exporter::instance().retire( buffer );
+}
+
+ThreadBuffer* registerThreadBuffer() noexcept
+{
+    if ( t_threadBufferReleased ) return nullptr;
+    try
+    {
+        thread_local ThreadBufferHolder holder;
+        holder.buffer  = Exporter::instance().registerThread();
+        t_threadBuffer = holder.buffer.get();
+        return t_threadBuffer;
+    }
+    catch ( ... )
+    {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Tracing::s_enabled = false;
+
+bool Tracing::start( const std::string& outputFile, std::chrono::milliseconds exportInterval )
+{
+    bool started = Exporter::instance().start( outputFile, exportInterval );
+    s_enabled    = started;
+    return started;
+}
+
+void Tracing::stop()
+{
+    s_enabled = false;
+    Exporter::instance().stop();
+}
+
+size_t Tracing::droppedSpans()
+{
+    return Exporter::instance().dropped();
+}
+
+uint64_t Tracing::now() noexcept
+{
+#ifdef CAFFA_TRACING_USE_TSC
+    return __rdtsc();
+#else
+    return steadyNanoseconds();
+#endif
+}
+
+void Tracing::record( const Span& span ) noexcept
+{
+    auto* bufferPointer = t_threadBuffer ? t_threadBuffer : registerThreadBuffer();
+    if ( !bufferPointer )
+    {
+        s_droppedWithoutBuffer.fetch_add( 1u, std::memory_order_relaxed );
+        return;
+    }
+
+    auto&  buffer = *bufferPointer;
+    size_t head   = buffer.head.load( std::memory_order_relaxed );
+    if ( head - buffer.cachedTail == ThreadBuffer::Capacity )
+    {
+        buffer.cachedTail = buffer.tail.load( std::memory_order_acquire );
+        if ( head - buffer.cachedTail == ThreadBuffer::Capacity )
+        {
+            buffer.dropped.fetch_add( 1u, std::memory_order_relaxed );
+            return;
+        }
+    }
+    buffer.spans[head % ThreadBuffer::Capacity] = span;
+    buffer.head.store( head + 1u, std::memory_order_release );
+}
@@ -0,0 +1,129 @@
+// ##################################################################################################
+//
+//    Caffa
+//    Copyright (C) 2026- Kontur AS
+//
+//    This library may be used under the terms of the GNU Lesser General Public License as follows:
+//
+//    GNU Lesser General Public License Usage
+//    This library is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as published by
+//    the Free Software Foundation; either version 2.1 of the License, or
+//    (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful, but WITHOUT ANY
+//    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//    FITNESS FOR A PARTICULAR PURPOSE.
+//
+//    See the GNU Lesser General Public License at <<http://www.gnu.org/licenses/lgpl-2.1.html>>
+//    for more details.
+//
+// ##################################################################################################
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace caffa
+{
+/**
+ * Low-overhead tracing of scopes, exported as Chrome trace event JSON that can be opened in Perfetto or
+ * chrome://tracing.
+ *
+ * Spans are recorded into a buffer per thread and written to file by a background exporter.
+ * When tracing is stopped a span costs a single branch, so spans can stay in production code.
+ * If a thread produces spans faster than the exporter drains them, the excess spans are dropped and counted.
+ */
+class Tracing
+{
+public:
+    struct Span
+    {
+        const char* name;
+        uint64_t    begin;
+        uint64_t    end;
+        const char* argumentName;
+        int64_t     argumentValue;
+    };
+
+    /**
+     * Start tracing to a file, which is overwritten.
+     * @param outputFile The Chrome trace event JSON file to write
+     * @param exportInterval How often the thread buffers are drained to file
+     * @return false if the file could not be opened, in which case tracing stays off
+     */
+    static bool start( const std::string&        outputFile,
+                       std::chrono::milliseconds exportInterval = std::chrono::milliseconds( 100 ) );
+
+    /**
+     * Stop tracing, write out the remaining spans and close the file
+     */
+    static void stop();
+
+    static bool enabled() noexcept { return s_enabled.load( std::memory_order_relaxed ); }
+
+    static size_t droppedSpans();
+
+    /**
+     * Time stamp for spans. Time stamp counter ticks on x86-64, otherwise steady clock nanoseconds.
+     */
+    static uint64_t now() noexcept;
+    static void     record( const Span& span ) noexcept;
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * Records a span from construction to destruction if tracing is enabled at construction.
+ * The name and argument name have to be string literals or otherwise outlive the tracing session.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope( const char* name ) noexcept
+        : TraceScope( name, nullptr, 0 )
+    {
+    }
+
+    TraceScope( const char* name, const char* argumentName, int64_t argumentValue ) noexcept
+    {
+        if ( Tracing::enabled() )
+        {
+            m_span = { name, Tracing::now(), 0u, argumentName, argumentValue };
+        }
+    }
+
+    ~TraceScope()
+    {
+        if ( m_span.name )
+        {
+            m_span.end = Tracing::now();
+            Tracing::record( m_span );
+        }
+    }
+
+    TraceScope( const TraceScope& )            = delete;
+    TraceScope& operator=( const TraceScope& ) = delete;
+
+private:
+    Tracing::Span m_span{};
+};
+
+} // namespace caffa
+
+#define CAFFA_TRACE_SCOPE_CONCAT_DETAIL( a, b ) a##b
+#define CAFFA_TRACE_SCOPE_CONCAT( a, b ) CAFFA_TRACE_SCOPE_CONCAT_DETAIL( a, b )
+
+/**
+ * Trace the enclosing scope. I.e. CAFFA_TRACE_SCOPE( "readFrame" );
+ */
+#define CAFFA_TRACE_SCOPE( NAME ) caffa::TraceScope CAFFA_TRACE_SCOPE_CONCAT( caffa_trace_scope_, __LINE__ )( NAME )
+
+/**
+ * Trace the enclosing scope with one integer argument. I.e. CAFFA_TRACE_SCOPE_ARG( "readFrame", "bytes", size );
+ */
+#define CAFFA_TRACE_SCOPE_ARG( NAME, ARGUMENT_NAME, ARGUMENT_VALUE ) \
+    caffa::TraceScope CAFFA_TRACE_SCOPE_CONCAT( caffa_trace_scope_, __LINE__ )( NAME, ARGUMENT_NAME, ARGUMENT_VALUE )
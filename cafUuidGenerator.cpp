@@ -21,6 +21,8 @@
 // ##################################################################################################
 #include "cafUuidGenerator.h"
 
+#include "cafProbes.h"
+
 #include <iostream>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
@@ -42,6 +44,14 @@ std::unique_ptr<boost::uuids::random_generator> UuidGenerator::s_uuidGenerator;
 std::mutex                                      UuidGenerator::s_mutex;
 
 std::string UuidGenerator::generate()
+{
+    CAFFA_PROBE( uuid_generate_entry );
+    auto uuid = generateLocked();
+    CAFFA_PROBE( uuid_generate_return );
+    return uuid;
+}
+
+std::string UuidGenerator::generateLocked()
 {
     std::scoped_lock lock( s_mutex );
 #ifndef NDEBUG
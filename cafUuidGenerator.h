@@ -42,6 +42,8 @@ namespace caffa
 #endif
 
     private:
+        static std::string generateLocked();
+
         static std::unique_ptr<boost::uuids::random_generator> s_uuidGenerator;
         static std::mutex s_mutex;
     };
@@ -0,0 +1,37 @@
+# Compiles a source file to assembly and checks that the given functions contain no compares, branches or calls.
+# Usage: cmake -DCOMPILER=<c++ compiler> -DSOURCE=<file> -DINCLUDE_DIR=<dir> -DOUTPUT=<assembly file>
+#              -DFUNCTIONS=<function>,<function> -P check_codegen.cmake
+
+execute_process(COMMAND ${COMPILER} -std=c++20 -O2 -S -fno-asynchronous-unwind-tables -I${INCLUDE_DIR} ${SOURCE}
+        -o ${OUTPUT}
+        RESULT_VARIABLE RESULT
+        ERROR_VARIABLE ERRORS)
+if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "Could not compile ${SOURCE}:\n${ERRORS}")
+endif ()
+
+file(STRINGS ${OUTPUT} LINES)
+string(REPLACE "," ";" FUNCTIONS "${FUNCTIONS}")
+foreach (FUNCTION ${FUNCTIONS})
+    set(INSIDE FALSE)
+    set(FOUND FALSE)
+    set(BODY "")
+    foreach (LINE IN LISTS LINES)
+        if (LINE MATCHES "^_?${FUNCTION}:")
+            set(INSIDE TRUE)
+            set(FOUND TRUE)
+        elseif (INSIDE AND LINE MATCHES "^[ \t]*\\.size[ \t]")
+            break()
+        elseif (INSIDE AND LINE MATCHES "^[ \t]+[a-z]")
+            string(STRIP "${LINE}" INSTRUCTION)
+            string(APPEND BODY "  ${INSTRUCTION}\n")
+            if (INSTRUCTION MATCHES "^(test|cmp|j[a-z]+|call|ud2)[a-z]*[ \t]*")
+                message(FATAL_ERROR "${FUNCTION} has a check left in it:\n${BODY}")
+            endif ()
+        endif ()
+    endforeach ()
+    if (NOT FOUND)
+        message(FATAL_ERROR "${FUNCTION} not found in ${OUTPUT}")
+    endif ()
+    message(STATUS "${FUNCTION}:\n${BODY}")
+endforeach ()
@@ -0,0 +1,17 @@
+# Checks that the USDT probes of the caffa provider made it into the ELF notes of a built library.
+# Usage: cmake -DREADELF=<readelf> -DLIBRARY=<library file> -DPROBES=<probe>,<probe> -P check_usdt_probes.cmake
+
+execute_process(COMMAND ${READELF} --notes ${LIBRARY}
+        OUTPUT_VARIABLE NOTES
+        RESULT_VARIABLE RESULT)
+
+if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "Could not read the ELF notes of ${LIBRARY}")
+endif ()
+
+string(REPLACE "," ";" PROBES "${PROBES}")
+foreach (PROBE ${PROBES})
+    if (NOT NOTES MATCHES "Provider: caffa[\r\n]+[ \t]*Name: ${PROBE}[\r\n]")
+        message(FATAL_ERROR "USDT probe caffa:${PROBE} is missing from ${LIBRARY}")
+    endif ()
+endforeach ()